@@ -1,7 +1,7 @@
 #!/bin/bash
 
 ## flags for compiler
-FLAGS="-Wall -Iinclude"
+FLAGS="-Wall -O2 -pthread -Iinclude"
 
 ## name of the .exe file
 OUT_NAME="app"
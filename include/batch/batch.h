@@ -0,0 +1,53 @@
+#ifndef BATCH_H
+#define BATCH_H
+
+#include "batch/corpus_reader.h"
+#include "board/board.h"
+#include "solver/solver.h"
+#include "solver/solver_engine.h"
+#include <ostream>
+#include <vector>
+
+#define BATCH_CHUNK_PER_THREAD 64 // puzzles read ahead for every thread of the parallel batch
+
+// Text format of the puzzle:
+//   rows cols
+//   rows * cols values separated by whitespaces (0 or '.' - empty cell)
+// Everything after '#' till the end of the line is a comment
+
+void write_board(std::ostream &out, Board &board);
+
+struct BatchResult {
+    int solution_count; // up to the limit, 0 if not solved
+    double time_ms;
+};
+
+// Solves the boards concurrently, one thread per context (the calling thread if there is one context).
+// Threads take the next unsolved board, so a slow puzzle doesn't hold the others.
+// Results are in the order of the boards. Solutions are counted up to the limit (see count_solutions)
+void solve_boards(
+    std::vector<Board *> &boards, std::vector<BatchResult> &results, std::vector<SolverContext> &contexts,
+    SolverEngine engine = SolverEngine::Backtracking, int search_threads = 1, int solution_limit = 1
+);
+
+struct BatchOptions {
+    bool is_binary = false; // solutions are written in the binary format (see board/binary_format.h)
+    bool fills_all_cells = false; // every empty cell is filled (see Board::fills_all_cells)
+    SolverEngine engine = SolverEngine::Backtracking;
+    int search_threads = 1; // split the search of every puzzle (see solve)
+    int batch_threads = 1; // puzzles solved at once
+    int table_mb = TABLE_DEFAULT_MB; // table of the failed states of every thread (see TranspositionTable)
+    ReplacementPolicy table_policy = ReplacementPolicy::KeepCostly;
+    int solution_limit = 1; // solutions counted for every puzzle, 2 checks that the solution is unique
+};
+
+// Solves every puzzle from the input one by one and writes solutions as soon as they are found.
+// With more than one batch thread puzzles are read in chunks, solved concurrently and written in the input order.
+// Returns number of puzzles that couldn't be solved
+int run_batch(CorpusReader &reader, std::ostream &out, const BatchOptions &options = BatchOptions());
+
+// Text puzzles are converted into binary, binary puzzles and solutions are converted into text
+// Returns number of converted records
+int convert_corpus(CorpusReader &reader, std::ostream &out);
+
+#endif
@@ -0,0 +1,66 @@
+#ifndef CORPUS_READER_H
+#define CORPUS_READER_H
+
+#include "board/board.h"
+#include <cstddef>
+#include <vector>
+
+#define READ_BUFFER_SIZE (64 * 1024) // for inputs that can't be mapped (pipes)
+#define RELEASE_CHUNK_SIZE (16 * 1024 * 1024) // parsed part of the mapped file is released by chunks
+
+enum class CorpusFormat {
+    Text, // see batch.h
+    BinaryPuzzles, // see board/binary_format.h
+    BinarySolutions
+};
+
+// Reads puzzles one by one, the format is detected by the first bytes of the input.
+// Regular files are mapped into memory and parsed in place, other inputs are read through
+// a small buffer (it grows only if a single binary record doesn't fit in it),
+// so memory usage doesn't depend on the size of the corpus
+class CorpusReader {
+    int fd;
+    bool is_mapped;
+    char *data; // mapped file
+    size_t data_size;
+    std::vector<char> buffer; // used instead of data if input can't be mapped
+    const char *pos; // next char to parse
+    const char *end; // end of the available data
+    const char *released; // mapped pages before this pointer were released
+    CorpusFormat format;
+    int puzzle_count;
+
+    // only for the solutions corpus
+    int last_solution_count; // 0 if not solved, see the solutions record in binary_format.h
+    int last_solve_time_us;
+
+    void close_input();
+
+    // Reads next chunk of the input. Unparsed chars are kept at the start of the buffer
+    // Returns false if the input is over
+    bool refill();
+    bool skip_to_token(); // skips whitespaces and comments. Returns false if the input is over
+    bool read_token(int &value); // reads number or '.' (empty cell)
+    void detect_format();
+    Board *next_text_board();
+    Board *next_binary_board();
+    void release_parsed_pages();
+
+public:
+    CorpusReader(const char *path); // nullptr or "-" for stdin
+    ~CorpusReader();
+
+    CorpusReader(const CorpusReader &) = delete;
+    CorpusReader &operator =(const CorpusReader &) = delete;
+
+    // Returns nullptr if there are no puzzles left
+    // Throws std::runtime_error if the puzzle is malformed
+    Board *next_board();
+
+    CorpusFormat get_format();
+    int get_puzzle_count();
+    int get_last_solution_count();
+    int get_last_solve_time_us();
+};
+
+#endif
@@ -0,0 +1,41 @@
+#ifndef BINARY_FORMAT_H
+#define BINARY_FORMAT_H
+
+#include <stdexcept>
+#include <vector>
+
+// Binary corpus starts with one of the magic strings and contains records one after another.
+//
+// Puzzle record:
+//   varint rows, varint cols
+//   clue bitmap: (rows * cols + 7) / 8 bytes, bit i (LSB first) is set if cell i is a clue
+//   varint value of every clue (cells go row by row)
+//
+// Solution record (Board::write_solution):
+//   puzzle record
+//   varint value of every cell that isn't a clue
+//   signed varint region id of every cell
+//   varint number of filled cells, varint index of every filled cell in Board::result order
+//
+// Record of the solutions corpus:
+//   byte n > 0 - solved, varint solve time in us, solution record. n is the number of solutions
+//     counted (see count_solutions), 1 if they weren't, up to BINARY_MAX_SOLUTION_COUNT
+//   byte 0 - not solved, varint solve time in us, puzzle record
+#define BINARY_MAGIC_LEN 4
+#define BINARY_MAX_SOLUTION_COUNT 255
+#define PUZZLES_MAGIC "FLP1"
+#define SOLUTIONS_MAGIC "FLS1"
+
+// thrown if record ends earlier than expected
+class TruncatedDataError : public std::runtime_error {
+public:
+    TruncatedDataError();
+};
+
+// LEB128 varints, 7 bits per byte
+void write_varint(std::vector<unsigned char> &out, unsigned int value);
+void write_svarint(std::vector<unsigned char> &out, int value); // zigzag encoding
+unsigned int read_varint(const unsigned char *&pos, const unsigned char *end);
+int read_svarint(const unsigned char *&pos, const unsigned char *end);
+
+#endif
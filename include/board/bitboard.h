@@ -0,0 +1,52 @@
+#ifndef BITBOARD_H
+#define BITBOARD_H
+
+#include "board/board.h"
+#include "board/coordinate.h"
+#include <cstdint>
+#include <vector>
+
+#define BITBOARD_WORD_BITS 64
+
+// Set of cells of the board, bit i is the cell with index i (see Board::idx_of).
+// Sentinels keep the padded layout: shifting by 1 or by the stride moves every bit to the adjacent
+// cell, and bits that cross the edge of the board land on sentinels, which are only in the blocked mask.
+// So flood fill runs on whole words: cells are grown into all directions at once and cut by the mask.
+// Word loops are plain, they are left to the vectorizer of the compiler
+class BitBoard {
+    std::vector<std::uint64_t> words;
+    int stride;
+    int low_word; // words outside [low_word, high_word] are zero (empty range if low > high)
+    int high_word;
+    std::vector<int> pending_words; // scratch of the flood fill
+    std::vector<char> is_pending; // by word, cleared when the word is popped
+
+    std::uint64_t shifted_word(int word_idx, int shift); // word of the set shifted to the higher bits
+    // Bits of the word grown into all directions inside the mask
+    std::uint64_t grown_word(int word_idx, std::uint64_t mask);
+    void push_pending(int word_idx);
+    void push_pending_adjs(int word_idx); // words that can get bits from this one
+    void update_range();
+
+public:
+    BitBoard(Board &board); // empty set of the board size
+
+    bool test(CellIdx idx) const { return words[idx / BITBOARD_WORD_BITS] >> (idx % BITBOARD_WORD_BITS) & 1; }
+    void set(CellIdx idx);
+    void clear();
+
+    // mask of the board, previous bits are replaced
+    void set_free_cells(Board &board); // empty cells that aren't in any region
+
+    int count() const;
+    int next_cell(CellIdx start) const; // first cell of the set from the start, -1 if none
+    void remove(const BitBoard &other);
+    void append_cells(std::vector<CellIdx> &out) const; // in the increasing order
+
+    // Grows the set through the cells of the mask until it holds whole connected components
+    // (cells outside the mask are dropped first). Only the words next to the changed ones are grown again,
+    // so the work follows the component, not the size of the board
+    void flood(const BitBoard &mask);
+};
+
+#endif
@@ -6,32 +6,68 @@
 #include "cell.h"
 #include <vector>
 
-#define BOARD_MAX_SIZE 20
+#define BOARD_MAX_CELLS (1 << 26) // limits memory of the board to 512 MB
+#define CACHE_LINE_SIZE 64
 
+// Cells are stored in one block aligned to the cache line. The grid is surrounded by the sentinel
+// cells (fixed, value 0, region id BORDER_REGION_ID): one row above, one row below and one column
+// after every row (it's also the column before the next row). So adjacent cells are found by
+// adding the offset to the index without any range checks, sentinels never match solver conditions
 class Board {
     int rows;
     int cols;
+    int stride; // cols + 1 sentinel
     int region_count;
-    Cell **board;
+    Cell *cells;
+    int adj_offsets[4]; // index offsets of adjacent cells in the Direction order (up, right, down, left)
 
 public:
     std::vector<int> values_on_board;
-    std::vector<Coord> fixed_cell_coords;
+    std::vector<CellIdx> fixed_cells;
     std::vector<Coord> result; // in which order cells were filled
+    // Every empty cell has to be in a region, regions that no clue reaches get the sizes found by the solver.
+    // Otherwise cells that no clue needs stay empty
+    bool fills_all_cells;
 
     Board(int rows, int cols);
     ~Board();
 
+    Board(const Board &) = delete;
+    Board &operator =(const Board &) = delete;
+
+    // Copies cells, regions counter, fixed cells, the result and the fill mode of the board of the same size
+    void copy_from(Board &other);
+
     int get_rows();
     int get_cols();
 
     Cell &cell_at(int row, int col);
     Cell &cell_at(Coord coord);
+
+    // unchecked access for the solver. Defined here because it's used in every step
+    Cell &at(CellIdx idx) { return cells[idx]; }
+    const int *get_adj_offsets() { return adj_offsets; }
+    CellIdx idx_of(int row, int col) { return (row + 1) * stride + col; }
+    CellIdx idx_of(Coord coord) { return idx_of(coord.row, coord.col); }
+    CellIdx idx_of(Cell &cell) { return static_cast<CellIdx>(&cell - cells); }
+    Coord coord_of(CellIdx idx);
+    Coord coord_of(Cell &cell);
+    int get_grid_size(); // number of cells including sentinels, all indexes are less than it
     void create_cell(int row, int col, int value, bool is_fixed = false);
     
     Region create_region(int target_size); 
     void create_fixed_cells_list();
     void fill_values_on_board();
+
+    // binary format (see board/binary_format.h), records are appended to the out vector
+    void write_puzzle(std::vector<unsigned char> &out);
+    void write_solution(std::vector<unsigned char> &out);
+
+    // pos is moved to the end of the record. Throw std::runtime_error if the record is invalid
+    static Board *read_puzzle(const unsigned char *&pos, const unsigned char *end);
+    static Board *read_solution(const unsigned char *&pos, const unsigned char *end);
 };
 
+bool is_valid_board_size(long long rows, long long cols);
+
 #endif
@@ -1,25 +1,31 @@
 #ifndef CELL_H
 #define CELL_H
 
-#include "board/coordinate.h"
 #include <ostream>
 
+#define MAX_CELL_VAL 99 // max value of the fixed cell
+#define CELL_FIXED_FLAG 0x80000000u // the highest bit of Cell::data
+#define BORDER_REGION_ID -3 // region id of the sentinel cells around the board
+
+// Cell is packed into 8 bytes: value with the fixed flag and region id.
+// Its position is known only by the board (see Board::coord_of)
+// Getters are defined here because the solver calls them in every step
 class Cell {
-    int value;
-    bool is_fixed;
-    Coord coord;
+    unsigned int data; // value in the lower 31 bits + fixed flag
 
 public:
     int region_id;
  
     Cell();
-    Cell(int row, int col, int value, bool is_fixed = true);
+    Cell(int value, bool is_fixed = true);
 
     // getters/setters
-    int get_value();
-    void set_value(int value);
-    bool get_is_fixed();
-    Coord get_coord();
+    int get_value() { return static_cast<int>(data & ~CELL_FIXED_FLAG); }
+    bool get_is_fixed() { return data & CELL_FIXED_FLAG; }
+    void set_value(int value) {
+        if (get_is_fixed()) return;
+        data = static_cast<unsigned int>(value);
+    }
 
     // for debugging
     friend std::ostream &operator <<(std::ostream &stream, Cell &cell);
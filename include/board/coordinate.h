@@ -3,6 +3,9 @@
 
 #include <ostream>
 
+// Index of the cell in the board grid (see Board::idx_of), solver uses it instead of Coord
+typedef int CellIdx;
+
 class Coord {
 public:
     int row;
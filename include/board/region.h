@@ -7,7 +7,7 @@
 class Region {
     int id; 
     int target_size; // -1 if it hasn't target size and always can grow 
-    std::vector<Coord> coords;
+    std::vector<CellIdx> cells;
 
 public:
     Region (int id, int target_size);
@@ -16,11 +16,10 @@ public:
     int get_target_size();
     int get_size();
     
-    void push(const Coord &coord);
-    Coord pop(); // returns Coord {-1, -1} if empty
-    Coord coord_at(int idx);
-    void remove_at(int idx);
+    void push(CellIdx idx);
+    CellIdx pop(); // returns -1 if empty
+    CellIdx cell_at(int pos); // pos isn't checked, must be in [0, get_size())
+    void reset(int target_size); // removes all cells, memory is kept for the next use
 };
 
 #endif
-
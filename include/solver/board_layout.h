@@ -0,0 +1,46 @@
+#ifndef BOARD_LAYOUT_H
+#define BOARD_LAYOUT_H
+
+#include "board/board.h"
+
+// Layouts give the solver offsets of the adjacent cells and the number of cells (see Board).
+// The solver is compiled for every layout, so with a fixed layout the offsets are constants
+// and loops over the directions are unrolled
+
+// Board of any size, the layout is read from it
+struct DynamicLayout {
+    int adj_offsets[4];
+    int grid_size;
+
+    DynamicLayout(Board &board) {
+        for (int dir = 0; dir < 4; dir++) {
+            adj_offsets[dir] = board.get_adj_offsets()[dir];
+        }
+
+        grid_size = board.get_grid_size();
+    }
+
+    const int *get_adj_offsets() const { return adj_offsets; }
+    int get_grid_size() const { return grid_size; }
+};
+
+// Board of ROWS x COLS cells, the layout is known at compile time
+template <int ROWS, int COLS>
+struct FixedLayout {
+    static constexpr int STRIDE = COLS + 1;
+    static constexpr int GRID_SIZE = (ROWS + 2) * STRIDE;
+    static constexpr int ADJ_OFFSETS[4] = { -STRIDE, 1, STRIDE, -1 };
+
+    FixedLayout(Board &) {}
+
+    const int *get_adj_offsets() const { return ADJ_OFFSETS; }
+    int get_grid_size() const { return GRID_SIZE; }
+};
+
+// sizes that are solved most often
+typedef FixedLayout<8, 8> Layout8x8;
+typedef FixedLayout<10, 10> Layout10x10;
+typedef FixedLayout<12, 12> Layout12x12;
+typedef FixedLayout<16, 16> Layout16x16;
+
+#endif
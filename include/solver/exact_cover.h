@@ -0,0 +1,101 @@
+#ifndef EXACT_COVER_H
+#define EXACT_COVER_H
+
+#include "board/board.h"
+#include "board/coordinate.h"
+#include "board/region.h"
+#include <unordered_map>
+#include <vector>
+
+#define EXACT_COVER_MAX_NODES (1 << 22) // bigger problems are left to the backtracking solver
+
+// Node of the dancing links matrix. Column headers are nodes too, primary ones are linked into the row of the root
+struct DlxNode {
+    int left;
+    int right;
+    int up;
+    int down;
+    int column; // header of the column
+    int data; // number of rows for the header, placement for the row node
+};
+
+// Shape of the region that can be placed on the board
+struct Placement {
+    int value; // also the number of cells
+    int first_cell; // cells are ExactCoverSolver::placement_cells[first_cell..first_cell + value)
+};
+
+// Node of the placement enumeration (the same Redelmeier scheme as SearchFrame, see solver.h)
+struct ShapeFrame {
+    int untried_begin; // untried cells of the node are ExactCoverSolver::untried[untried_pos..untried_end)
+    int untried_pos;
+    int untried_end;
+    int shape_mark; // size of the shape before the node added its cells
+    int seen_mark; // size of the seen trail before the node was created
+};
+
+// Engine that turns the puzzle into exact cover. Every legal shape of every clue group is enumerated
+// up front, then one shape per group is chosen by Algorithm X on dancing links.
+// Rows are placements. Primary columns (covered exactly once) are clue groups, the placement covers every
+// group it merges. Secondary columns (covered at most once) are free cells and pairs of adjacent cells for
+// every value: the placement covers all pairs it touches, so placements of the same value that touch
+// each other share a column.
+// Number of shapes grows exponentially with the clue value, so it fits boards with many small clues
+class ExactCoverSolver {
+    Board &board;
+    std::vector<Region> groups; // connected clues with the same value, ids are indexes
+    std::vector<int> group_of; // by cell, -1 if the cell isn't in a group
+    std::vector<Placement> placements;
+    std::vector<CellIdx> placement_cells;
+    std::vector<DlxNode> nodes; // nodes[0] is the root, nodes[1 + i] is the header of groups[i]
+    std::vector<int> cell_columns; // by cell, 0 if there is no column yet
+    std::unordered_map<long long, int> edge_columns; // by the pair of cells and the value
+    std::vector<int> chosen; // row nodes chosen on the levels of the search
+
+    // scratch of the enumeration
+    std::vector<ShapeFrame> frames;
+    std::vector<CellIdx> shape;
+    std::vector<CellIdx> untried;
+    std::vector<CellIdx> seen_trail;
+    std::vector<char> is_seen; // by cell
+    std::vector<char> is_in_shape; // by cell
+    int visited_count; // shapes visited by all enumerations
+
+    bool create_groups(); // false if some clue group is bigger than its value
+    bool is_allowed(CellIdx idx, int value); // free cell or a clue with the value
+    void push_shape_cells(CellIdx idx); // the cell or the whole group it belongs to
+    // Adds cells adjacent to the shape members from first_member that weren't seen to the untried list.
+    // Group gets one cell in the list, so it's tried once
+    void add_untried_adjs(ShapeFrame &frame, int first_member, int value);
+    void pop_shape_frame();
+    bool is_legal_shape(int value); // the shape doesn't touch clues of its value it doesn't include
+    void add_placement(int value);
+    // Enumerates shapes of the value that include the group and no group with the smaller index,
+    // so every placement is found once. Returns false if the limit is exceeded
+    bool enumerate_placements(int group_idx);
+
+    int add_column(bool is_primary);
+    void add_row_node(int column, int placement_idx, int &first_node);
+    int edge_column(CellIdx idx_a, CellIdx idx_b, int value);
+    void add_row(int placement_idx);
+    bool build_matrix(); // false if there are too many nodes
+
+    void cover(int column);
+    void uncover(int column);
+    int choose_column(); // primary column with the fewest rows
+    // The last chosen row is undone and the next row of its column is taken.
+    // Returns false if nothing was chosen (the column is uncovered)
+    bool next_row(int &column, int &row);
+    // Counts the covers up to the limit, the first one is written to the board. Returns their number
+    int search(int solution_limit);
+    void fill_result();
+
+public:
+    ExactCoverSolver(Board &board);
+
+    // Returns the number of solutions up to the limit (1 if solved, 0 if there is no solution by default),
+    // -1 if the puzzle is too big for this engine (the board stays untouched then)
+    int solve(int solution_limit = 1);
+};
+
+#endif
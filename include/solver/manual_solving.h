@@ -4,6 +4,7 @@
 #include "board/board.h"
 
 bool is_correctly_solved(Board &board);
+bool validate_single_cells(Board *p_board); // false if two cells with value 1 are adjacent
 
 #endif
 
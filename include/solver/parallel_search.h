@@ -0,0 +1,73 @@
+#ifndef PARALLEL_SEARCH_H
+#define PARALLEL_SEARCH_H
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <vector>
+
+#define SEARCH_POLL_INTERVAL 256 // search steps between the checks of the shared state
+
+// Subtree of the search given to another thread. The search is deterministic, so the node is rebuilt
+// from the root by replaying the children chosen on the way (see Solver::run_task)
+struct SearchTask {
+    std::vector<int> path; // positions of the chosen children, nodes with the only child aren't listed
+    int child_begin; // children of the node in the task, the others belong to other tasks
+    int child_end;
+};
+
+// Tasks of one thread. The owner takes the newest task (its subtree is the smallest and
+// the board of the owner is close to it), other threads steal the oldest ones
+class TaskDeque {
+    std::mutex mutex;
+    std::deque<SearchTask> tasks;
+
+public:
+    void push(SearchTask &&task);
+    bool pop(SearchTask &task);
+    bool steal(SearchTask &task);
+    bool is_empty();
+};
+
+// State shared by the threads that solve one puzzle. Each thread has its own board and solver,
+// they share only the tasks, the flag that stops the search and the number of solutions found
+class ParallelSearch {
+    std::vector<TaskDeque> deques; // by thread
+    std::atomic<bool> is_stopped;
+    std::atomic<int> task_count; // tasks that were created and aren't finished yet
+    std::atomic<int> idle_count; // threads that are looking for a task
+    std::atomic<int> solution_count;
+    int solution_limit; // the search is stopped when this many solutions are found
+    // Idle threads sleep until the tasks or the stop change, every change increases the event count
+    std::mutex wait_mutex;
+    std::condition_variable wait_signal;
+    long long event_count;
+
+    void notify_waiting();
+
+public:
+    ParallelSearch(int thread_count, int solution_limit = 1);
+
+    int get_thread_count() { return static_cast<int>(deques.size()); }
+
+    void push_task(int thread_idx, SearchTask &&task);
+    // Own task or the stolen one. Sleeps while other threads are busy, so they can split their work.
+    // Returns false when all tasks are finished or the search is stopped
+    bool next_task(int thread_idx, SearchTask &task);
+    void finish_task();
+
+    // Threads split their work only when someone is idle and their own tasks are taken
+    bool wants_task(int thread_idx);
+    // The first thread that found a solution stops the others. Returns false if it isn't the first
+    bool stop();
+    bool get_is_stopped() { return is_stopped.load(std::memory_order_relaxed); }
+    // Counts the solution found by the thread, the last one up to the limit stops the search.
+    // Returns true if it's the first one, its thread keeps it for the board. With the limit of 1
+    // the solution has to claim the stop (see stop), a failed thread of the portfolio may be the first
+    bool add_solution();
+    int get_solution_count() { return std::min(solution_count.load(), solution_limit); }
+};
+
+#endif
@@ -0,0 +1,193 @@
+#ifndef POLYOMINO_H
+#define POLYOMINO_H
+
+#include <cstdint>
+
+// Regions with bigger values are grown cell by cell: there are thousands of shapes of 7 or 8 cells, and
+// on a crowded board scanning all their placements costs more than growing only through the free cells.
+// The table is built by the compiler, sizes above 8 exceed its default limit of constexpr operations
+#define POLYOMINO_MAX_SIZE 5
+#define POLYOMINO_MAX_BORDER (2 * POLYOMINO_MAX_SIZE + 2)
+// Shape fits into the square window centered on any of its cells. Window cells are bits in the row-major order
+#define POLYOMINO_WINDOW_WIDTH (2 * POLYOMINO_MAX_SIZE - 1)
+#define POLYOMINO_WINDOW_WORDS ((POLYOMINO_WINDOW_WIDTH * POLYOMINO_WINDOW_WIDTH + 63) / 64)
+
+// Offset of the cell from the origin of the shape
+struct PolyominoCell {
+    int row;
+    int col;
+};
+
+// Fixed polyomino (rotations and reflections are different shapes). The origin is its first cell in the
+// row-major order, so rows of the cells are never negative, columns can be
+struct Polyomino {
+    int size;
+    int max_row;
+    int min_col;
+    int max_col;
+    PolyominoCell cells[POLYOMINO_MAX_SIZE]; // cells[0] is the origin
+    int border_size;
+    PolyominoCell border[POLYOMINO_MAX_BORDER]; // cells adjacent to the shape
+    std::uint64_t window[POLYOMINO_WINDOW_WORDS]; // cells in the window centered on the origin
+};
+
+// number of fixed polyominoes of every size, it's the capacity of the table and the check of the enumeration
+constexpr int POLYOMINO_COUNTS[11] = { 0, 1, 2, 6, 19, 63, 216, 760, 2725, 9910, 36446 };
+
+constexpr int polyomino_total_count() {
+    int count = 0;
+    for (int size = 1; size <= POLYOMINO_MAX_SIZE; size++) {
+        count += POLYOMINO_COUNTS[size];
+    }
+
+    return count;
+}
+
+// Shapes of all sizes up to POLYOMINO_MAX_SIZE, grouped by the size
+struct PolyominoLibrary {
+    Polyomino shapes[polyomino_total_count()];
+    int first_of_size[POLYOMINO_MAX_SIZE + 2]; // shapes of the size are [first_of_size[size]..first_of_size[size + 1])
+    int count;
+};
+
+// Cells of the enumeration grid: rows [0, POLYOMINO_MAX_SIZE), columns (-POLYOMINO_MAX_SIZE, POLYOMINO_MAX_SIZE)
+constexpr int POLYOMINO_GRID_WIDTH = 2 * POLYOMINO_MAX_SIZE;
+
+constexpr int polyomino_grid_idx(PolyominoCell cell) {
+    return cell.row * POLYOMINO_GRID_WIDTH + cell.col + POLYOMINO_MAX_SIZE;
+}
+
+// bit of the cell in the window, row and column are relative to the center
+constexpr int polyomino_window_bit(int row, int col) {
+    return (row + POLYOMINO_MAX_SIZE - 1) * POLYOMINO_WINDOW_WIDTH + col + POLYOMINO_MAX_SIZE - 1;
+}
+
+// Grid of the shape with its border: rows [-1, POLYOMINO_MAX_SIZE], columns [-POLYOMINO_MAX_SIZE, POLYOMINO_MAX_SIZE]
+constexpr int POLYOMINO_BORDER_GRID_WIDTH = 2 * POLYOMINO_MAX_SIZE + 1;
+
+constexpr int polyomino_border_grid_idx(PolyominoCell cell) {
+    return (cell.row + 1) * POLYOMINO_BORDER_GRID_WIDTH + cell.col + POLYOMINO_MAX_SIZE;
+}
+
+// Completes the enumerated shape (bounds and border) and appends it to the library
+constexpr void add_polyomino(PolyominoLibrary &library, const Polyomino &enumerated) {
+    const int rows[4] = { -1, 0, 1, 0 };
+    const int cols[4] = { 0, 1, 0, -1 };
+
+    Polyomino &shape = library.shapes[library.count++];
+    shape = enumerated;
+    shape.max_row = shape.min_col = shape.max_col = 0;
+    shape.border_size = 0;
+
+    bool is_listed[(POLYOMINO_MAX_SIZE + 2) * POLYOMINO_BORDER_GRID_WIDTH] = {};
+    for (int i = 0; i < shape.size; i++) {
+        PolyominoCell cell = shape.cells[i];
+        is_listed[polyomino_border_grid_idx(cell)] = true;
+        int bit = polyomino_window_bit(cell.row, cell.col);
+        shape.window[bit / 64] |= std::uint64_t(1) << (bit % 64);
+        shape.max_row = cell.row > shape.max_row ? cell.row : shape.max_row;
+        shape.min_col = cell.col < shape.min_col ? cell.col : shape.min_col;
+        shape.max_col = cell.col > shape.max_col ? cell.col : shape.max_col;
+    }
+
+    for (int i = 0; i < shape.size; i++) {
+        for (int dir = 0; dir < 4; dir++) {
+            PolyominoCell adj = { shape.cells[i].row + rows[dir], shape.cells[i].col + cols[dir] };
+            if (is_listed[polyomino_border_grid_idx(adj)]) continue;
+
+            is_listed[polyomino_border_grid_idx(adj)] = true;
+            shape.border[shape.border_size++] = adj;
+        }
+    }
+}
+
+// Redelmeier enumeration: the untried cell is added to the shape and stays seen, so the shapes of
+// the next branches never have it. The child gets the rest of the untried cells and the neighbours of the
+// added cell that weren't seen. Cells before the origin in the row-major order are never added,
+// so every fixed polyomino is found once
+constexpr void grow_polyominoes(
+    PolyominoLibrary &library, Polyomino &shape, int size, int target_size,
+    const PolyominoCell *untried, int untried_count, bool *is_seen
+) {
+    const int rows[4] = { -1, 0, 1, 0 };
+    const int cols[4] = { 0, 1, 0, -1 };
+
+    while (untried_count > 0) {
+        untried_count--;
+        PolyominoCell cell = untried[untried_count];
+        shape.cells[size] = cell;
+        if (size + 1 == target_size) {
+            shape.size = target_size;
+            add_polyomino(library, shape);
+            continue;
+        }
+
+        PolyominoCell child_untried[4 * POLYOMINO_MAX_SIZE] = {};
+        int child_count = 0;
+        for (int i = 0; i < untried_count; i++) {
+            child_untried[child_count++] = untried[i];
+        }
+
+        PolyominoCell new_cells[4] = {};
+        int new_count = 0;
+        for (int dir = 0; dir < 4; dir++) {
+            PolyominoCell adj = { cell.row + rows[dir], cell.col + cols[dir] };
+            bool is_allowed = adj.row > 0 || (adj.row == 0 && adj.col > 0);
+            if (!is_allowed || adj.row >= target_size || adj.col <= -target_size || adj.col >= target_size) continue;
+            if (is_seen[polyomino_grid_idx(adj)]) continue;
+
+            is_seen[polyomino_grid_idx(adj)] = true;
+            new_cells[new_count++] = adj;
+            child_untried[child_count++] = adj;
+        }
+
+        grow_polyominoes(library, shape, size + 1, target_size, child_untried, child_count, is_seen);
+
+        for (int i = 0; i < new_count; i++) {
+            is_seen[polyomino_grid_idx(new_cells[i])] = false;
+        }
+    }
+}
+
+constexpr PolyominoLibrary build_polyomino_library() {
+    PolyominoLibrary library = {};
+    for (int size = 1; size <= POLYOMINO_MAX_SIZE; size++) {
+        library.first_of_size[size] = library.count;
+
+        bool is_seen[POLYOMINO_MAX_SIZE * POLYOMINO_GRID_WIDTH] = {};
+        PolyominoCell origin = { 0, 0 };
+        is_seen[polyomino_grid_idx(origin)] = true;
+
+        Polyomino shape = {};
+        grow_polyominoes(library, shape, 0, size, &origin, 1, is_seen);
+    }
+
+    library.first_of_size[POLYOMINO_MAX_SIZE + 1] = library.count;
+    return library;
+}
+
+// Built by the compiler, shared by all solves
+inline constexpr PolyominoLibrary POLYOMINOES = build_polyomino_library();
+
+static_assert(POLYOMINOES.count == polyomino_total_count(), "Polyomino enumeration is incomplete");
+
+// Checks that the shape with its cell at the center of the window covers only the cells of the window.
+// Cells after the origin have bigger bits, so the window of the shape is shifted down by the bit of that cell
+inline bool polyomino_fits(const Polyomino &shape, PolyominoCell center, const std::uint64_t *window) {
+    int shift = center.row * POLYOMINO_WINDOW_WIDTH + center.col;
+    int word_shift = shift / 64;
+    int bit_shift = shift % 64;
+
+    for (int i = 0; i + word_shift < POLYOMINO_WINDOW_WORDS; i++) {
+        std::uint64_t word = shape.window[i + word_shift] >> bit_shift;
+        if (bit_shift != 0 && i + word_shift + 1 < POLYOMINO_WINDOW_WORDS) {
+            word |= shape.window[i + word_shift + 1] << (64 - bit_shift);
+        }
+
+        if ((word & ~window[i]) != 0) return false;
+    }
+
+    return true;
+}
+
+#endif
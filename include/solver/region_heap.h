@@ -0,0 +1,32 @@
+#ifndef REGION_HEAP_H
+#define REGION_HEAP_H
+
+#include <climits>
+#include <vector>
+
+#define REGION_KEY_MAX INT_MAX // key of the regions that don't have to be grown
+
+// Indexed binary min-heap of regions. Every region stays in the heap, so it's never rebuilt:
+// completed regions get REGION_KEY_MAX and go to the bottom. Key of any region can be changed in O(log n)
+class RegionHeap {
+    std::vector<int> heap; // region indexes
+    std::vector<int> positions; // position of the region in the heap
+    std::vector<int> keys;
+    std::vector<int> ranks; // order of the regions with equal keys
+
+    bool is_less(int pos_a, int pos_b); // ties are broken by the rank
+    void swap_at(int pos_a, int pos_b);
+    void sift_up(int pos);
+    void sift_down(int pos);
+
+public:
+    // All keys are 0. Regions are ranked by index if the seed is 0, otherwise ranks are shuffled by it
+    void reset(int region_count, unsigned int tie_seed = 0);
+
+    int get_top(); // region with the smallest key
+    int get_key(int region_idx);
+    void set_key(int region_idx, int key);
+    void push(int key); // adds the region with the next index, it's ranked after all others
+};
+
+#endif
@@ -3,9 +3,380 @@
 
 #include "board/board.h"
 #include "board/cell.h"
+#include "board/coordinate.h"
 #include "board/region.h"
+#include "solver/board_layout.h"
+#include "solver/parallel_search.h"
+#include "solver/polyomino.h"
+#include "solver/region_heap.h"
+#include "solver/solver_engine.h"
+#include "solver/transposition_table.h"
+#include <cstdint>
+#include <memory>
+#include <vector>
 
-bool solve(Board &board);
-bool solve(Board &board, Region *p_region, Cell &cell);
+#define AREA_CHECK_LIMIT 1024 // bigger free areas aren't checked after every region
+#define PORTFOLIO_DEFAULT_SIZE 4 // configurations raced if the number of threads isn't given
+#define CONFLICT_SCOPE_LIMIT 1024 // failure with the bigger scope is blamed on all previous decisions
+#define CONFLICT_MAX_LEVELS 64 // lower levels of the bigger conflict are kept as the floor
+#define NOGOOD_TABLE_MB 1
+
+// Node of the search: state of the region after some cells were added to it.
+// Shapes of the region are enumerated without repeats (Redelmeier): children of the node add cells
+// from its untried list one by one. The child gets the rest of the list and the free cells adjacent
+// to the added one that weren't seen in this enumeration yet. So the cell tried by the node is never
+// added in the subtrees of its next children
+struct SearchFrame {
+    int region_idx; // in Solver::regions
+    int seen_id; // id of the enumeration (see Solver::seen_ids)
+    int untried_begin; // untried cells of the node are Solver::untried[untried_pos..untried_end)
+    int untried_pos;
+    int untried_end;
+    int trail_mark; // size of the trail before the node was created
+    int seen_mark; // size of the seen trail before the node was created
+    // Small regions are placed as whole shapes instead (see polyomino.h): children of the node are
+    // placements [shape_pos..shape_end), the placement is the shape and its cell at the first region cell.
+    // shape_end is 0 for the nodes that grow the region cell by cell
+    int shape_pos;
+    int shape_end;
+    // Children are tried up to this position (untried_end or shape_end). It's lower if the rest of them
+    // were given to another thread, their subtrees still have the whole untried list
+    int child_end;
+    // Some children belong to another thread or the counted solution was below the node,
+    // so the failure doesn't prove anything
+    bool is_split;
+    long long step_mark; // search steps before the node was created
+    // Cell that starts the blank region, -1 for the other nodes (see Solver::push_blank_frame).
+    // Children of the blank node are region nodes of its sizes [untried_pos..child_end), it starts a level too
+    CellIdx blank_cell;
+};
+
+// Result of pushing the next child of the top node
+enum class SearchStep {
+    NoChildren, // all children were tried
+    DeadEnd, // the child is on top, but it has no solutions
+    Pushed,
+    Solved // the child completed the last region
+};
+
+// Choices that change the order of the search tree and its pruning, not the solutions.
+// Runtimes of hard puzzles depend heavily on the order, so the portfolio races several configurations
+struct SearchConfig {
+    int directions[4]; // order in which neighbours of the new cells are added to the untried list
+    unsigned int tie_seed; // order of the regions with equal keys (see RegionHeap::reset)
+    int area_check_limit; // areas near the completed regions are checked up to this size, 0 - not checked
+    bool uses_backjumping; // false - the search backtracks one decision at a time
+};
+
+inline constexpr SearchConfig DEFAULT_SEARCH_CONFIG = { { 0, 1, 2, 3 }, 0, AREA_CHECK_LIMIT, true };
+
+// Configuration of the portfolio thread, the first one is the default
+SearchConfig portfolio_config(int idx);
+
+// Previous enumeration id of the cell
+struct SeenEntry {
+    CellIdx idx;
+    int seen_id;
+};
+
+enum class TrailKind {
+    Cell, // free cell was added to the region, it's the last cell of the region
+    Merge, // another region was merged into the region
+    Key, // key of the region in the heap was changed
+    Target, // target size of the blank region was set
+    BlankScan // scan for the next blank cell moved past the filled cells, value is its old position
+};
+
+// Decision of the search: the region node and what the failures of its children depend on.
+// Failure is decided by its scope - free cells and unfinished regions connected to the regions that were
+// checked, with the completed regions around them. Cells of the scope were filled by the decisions of
+// the conflict, the later ones can't reach it, so the search jumps back to the latest decision
+// of the conflict instead of the previous one (conflict-directed backjumping)
+struct SearchLevel {
+    int frame_idx; // region node of the level, or the blank node that chooses the size of the blank region
+    int conflict_floor; // conflict includes all levels below the floor
+    std::vector<int> conflict; // levels above the floor, ascending
+    std::vector<int> checked_regions; // unfinished regions checked by the propagation after the children
+    bool is_leaf; // every child failed before the next region, so the scope proves the failure alone
+    bool is_split; // some children belong to another thread or a solution was counted below the level
+};
+
+// Component in SolverContext::component_cells: its own cells are [begin, inside_end),
+// cells of the completed regions (and of the clues of 1 in the full fill) around it are [inside_end, end)
+struct ComponentBounds {
+    int begin;
+    int inside_end;
+    int end;
+};
+
+// Change of the solver state that can be undone
+struct TrailEntry {
+    TrailKind kind;
+    int region_idx;
+    int value; // merged region, the old key or the old target size
+};
+
+// Storage of the solver state. It's reused by the solves of one thread, so the vectors keep their
+// memory between the puzzles and the steady state of the batch doesn't allocate
+struct SolverContext {
+    std::vector<Region> regions; // indexes never change, merged regions stay in the list
+    std::vector<int> merged_into; // -1 if the region is alive
+    std::vector<SearchFrame> frames;
+    std::vector<CellIdx> untried; // lists of the nodes, each one is on top of its parent's
+    // Enumeration that saw the cell last: index of its first frame + 1, 0 if none. Ids are restored
+    // when frames are popped, so enumeration of the next region doesn't change marks of the previous one
+    std::vector<int> seen_ids;
+    std::vector<SeenEntry> seen_trail;
+    // Changes in the order they were made. Later changes always belong to deeper nodes,
+    // so the node is undone by popping the trail down to its mark, O(1) per cell
+    std::vector<TrailEntry> trail;
+    std::vector<int> propagation_queue; // regions that have to be checked
+    std::vector<char> is_queued;
+    // Regions by the slack between the number of free cells they can grow into and the number of cells
+    // they still need, then by the number of needed cells. Keys are updated only for the regions
+    // checked by the propagation
+    RegionHeap region_heap;
+    // Cell is marked in the current pass if its mark equals Solver::mark_stamp, so marks are never cleared
+    std::vector<unsigned int> cell_marks;
+    std::vector<CellIdx> flood_queue; // scratch of can_reach_target and check_area
+    std::vector<unsigned int> region_marks; // the same as cell_marks, but for regions
+    std::vector<int> area_regions; // scratch of check_area and find_components
+    // Boards that have no solutions, found when the node of the next region fails. The node enumerates
+    // all shapes of the region, so its failure depends only on the values of the cells, not on the path.
+    // One search never reaches the same board twice (sibling subtrees differ in the cells of the region),
+    // so the table is used by the portfolio, where threads reach boards in different orders
+    TranspositionTable failed_states;
+    std::vector<int> cell_levels; // level that filled the cell, -1 for the clues and the cells filled by start
+    std::vector<SearchLevel> levels; // by level, entries above the current one keep their memory
+    std::vector<int> scope_levels; // scratch of the scope flood
+    std::vector<int> conflict_scratch;
+    // Scopes of the leaf levels that failed (see SearchLevel). The board with the same scope around
+    // any region fails too, whatever is outside the scope, so the nogoods are found by other branches
+    TranspositionTable learned_nogoods;
+    // Parts of the board found after the start (see Solver::find_components)
+    std::vector<CellIdx> component_cells;
+    std::vector<ComponentBounds> component_bounds;
+    std::vector<Cell> solution_cells; // first solution of the counting search, by cell
+    // Contexts of the other threads of the solve (see solve), [i] belongs to the thread i + 1.
+    // They are created by the first solve that needs them and reused by the next ones
+    std::vector<std::unique_ptr<SolverContext>> thread_contexts;
+};
+
+// Backtracking search on an explicit stack, so the depth of the search
+// (it grows with the number of cells) isn't limited by the call stack.
+// Every group of connected clues with the same value is a region from the start, regions with
+// the same value that touch each other are merged. Search grows regions one by one, the most constrained
+// region is the next. Constraints are propagated before the search and after every completed region
+// (see propagation.cpp), which also updates the order of the regions.
+// Layout gives offsets of the adjacent cells (see board_layout.h), the solver is instantiated for
+// the common board sizes, so their offsets are constants
+template <class Layout>
+class Solver {
+    Board &board;
+    Layout layout;
+    SolverContext own_context; // empty if the context is given
+    // fields of the context (see SolverContext)
+    std::vector<Region> &regions;
+    std::vector<int> &merged_into;
+    std::vector<SearchFrame> &frames;
+    std::vector<CellIdx> &untried;
+    std::vector<int> &seen_ids;
+    std::vector<SeenEntry> &seen_trail;
+    std::vector<TrailEntry> &trail;
+    std::vector<int> &propagation_queue;
+    std::vector<char> &is_queued;
+    RegionHeap &region_heap;
+    std::vector<unsigned int> &cell_marks;
+    std::vector<CellIdx> &flood_queue;
+    std::vector<unsigned int> &region_marks;
+    std::vector<int> &area_regions;
+    std::vector<CellIdx> &component_cells;
+    std::vector<ComponentBounds> &component_bounds;
+    TranspositionTable *p_failed_states; // shared by the portfolio threads, nullptr otherwise
+    std::vector<int> &cell_levels;
+    std::vector<SearchLevel> &levels;
+    std::vector<int> &scope_levels;
+    std::vector<int> &conflict_scratch;
+    TranspositionTable &learned_nogoods;
+    int level_count; // region nodes on the stack
+    std::uint64_t state_key; // Zobrist key of the cells filled by the solver (see zobrist_key)
+    long long step_count;
+    int region_id_base; // id of regions[0]
+    unsigned int mark_stamp;
+    SearchConfig config;
+    int root_region_idx; // region of the first node, set by start
+    CellIdx root_blank_cell; // the first node is the blank node of the cell if it isn't -1
+    // Smallest area no unfinished region reaches found by the area checks of the step, -1 if there is none.
+    // Only blank regions can fill it, so it's filled before the next regions: its failure cuts the branch early
+    CellIdx closed_area_cell;
+    int closed_area_size;
+    // Regions from this index are the slots of the blank regions (see push_blank_frame). Slots are added
+    // when the branch needs more of them and reused by the next branches, so the lists never shrink
+    int first_blank_idx;
+    int blank_depth; // blank nodes on the stack, the next one takes the slot after theirs
+    // Cells before it are filled, so the scan for the next blank cell starts here. Cells are freed only
+    // by the trail, which moves the position back, so every cell is scanned once in the branch
+    CellIdx blank_scan_idx;
+    // set if the solver is one of the threads of the parallel search, nullptr otherwise
+    ParallelSearch *p_parallel;
+    int thread_idx;
+    int task_depth; // index of the frame of the current task, frames below it are the path to it
+    int poll_countdown; // steps until the next check of the shared state
+    std::vector<Cell> &solution_cells;
+    int solution_limit;
+    int solution_count; // found by this solver
+    bool has_first_solution; // the first solution is in the result, and in solution_cells if the search went on
+
+    int region_idx_of(CellIdx idx); // -1 if the cell isn't owned by any region
+    bool is_completed(int region_idx);
+    bool create_regions(); // false if some clue group is bigger than its value
+    void new_mark_pass();
+    // The next count passes get increasing stamps, so the marks of all of them are found by the range
+    void reserve_mark_passes(unsigned int count);
+    void reset_marks(); // the stamp starts again, old marks could match it
+
+    // Size of the region after adding the free cell with all regions of the same value it touches
+    int size_after_adding(int region_idx, CellIdx idx);
+    // Adds the free cell and merges regions of the same value it touches. Returns false if region overflows
+    bool add_cell(int region_idx, CellIdx idx);
+    void merge_region(int region_idx, int merged_idx);
+    void set_region_key(int region_idx, int key);
+    void undo_to(int trail_mark);
+
+    bool next_candidate(SearchFrame &frame, CellIdx &idx);
+    int next_open_region(); // the most constrained region, -1 if all regions are completed
+    // Cell the next blank region starts from: a cell of the closed area, or the first free cell if all regions
+    // are completed. -1 if the next node is a region one or the board doesn't fill all cells
+    CellIdx next_blank_cell(bool has_open_regions);
+    void push_frame(int region_idx, int seen_id);
+    void push_level(); // node on top starts the level
+    // Adds free cells adjacent to the members from first_member that weren't seen to the untried list
+    void add_untried_adjs(SearchFrame &frame, int first_member);
+    // Starts the enumeration of the region shapes. The blank region is started here from its cell with
+    // the target size, so both are undone with the node
+    void push_region_frame(int region_idx, CellIdx blank_cell = -1, int blank_size = 0);
+    void push_root_frame();
+    // Full fill: the free cell is in some region that no clue reached. Its size is chosen by the node:
+    // it's at most the free area around the cell (up to MAX_CELL_VAL) and differs from the values
+    // of the adjacent cells, the region would touch the region of its own size
+    void push_blank_frame(CellIdx idx);
+    bool next_blank_size(SearchFrame &frame, int &size);
+    bool touches_value(CellIdx idx, int value);
+    void set_region_target(int region_idx, int target_size);
+    // Child of the top node that adds the cell. Returns false if the cell can't be added (child stays on top)
+    bool push_child_frame(CellIdx idx);
+    // Shape can be placed if its cells are free or belong to the whole regions of the same value
+    // (the region itself included) and no region of the same value is next to it
+    bool is_legal_placement(int region_idx, const Polyomino &shape, CellIdx origin);
+    // Window of the cells around the center (see polyomino.h) the region can cover:
+    // free cells and cells of the regions with the same value
+    void fill_placement_window(int region_idx, CellIdx center, std::uint64_t *window);
+    // next legal placement of the shape node, origin is the index of the shape origin on the board
+    bool next_placement(SearchFrame &frame, const Polyomino *&p_shape, CellIdx &origin);
+    void push_placement_frame(const Polyomino &shape, CellIdx origin); // child that completes the region
+    void pop_frame();
+    void fill_result();
+    static int &child_pos_of(SearchFrame &frame) { return frame.shape_end != 0 ? frame.shape_pos : frame.untried_pos; }
+    SearchStep push_next_child();
+    // Child on top completed the last region. The first solution is kept, the search goes on
+    // from the next child until the limit. Returns true if the search stops
+    bool count_solution();
+    void count_start_solution(); // the board was solved by the start
+    // Depth-first search until the frame at base_depth is popped. Returns true if the solution limit
+    // was reached, false if the tree ran out of solutions or the parallel search was stopped
+    bool search(int base_depth);
+    // Gives the second half of the untried children of the shallowest node in the current task to the task.
+    // Returns false if every node has less than 2 untried children
+    bool split(SearchTask &task);
+    bool poll(); // shares the work with the idle threads. Returns false if the search was stopped
+    void add_component(int begin); // floods the component from its cells after begin, appends its bounds
+
+    // =-=-= backjumping =-=-=
+    void add_scope_region(int region_idx, std::uint64_t &key); // completed region only borders the scope
+    // Floods the scope from the region (see SearchLevel) in the current mark pass, appends levels of
+    // its regions to scope_levels and cell keys to the key. Returns false if the scope exceeds the limit
+    bool add_scope(int region_idx, std::uint64_t &key);
+    bool flood_scope(long unsigned int first, std::uint64_t &key); // floods from the cells of the queue after first
+    // Adds the scope of the failed children to the conflict of the level. is_closed is false if
+    // some checked region is outside the scope of the level's region. Returns false if the scope is too big
+    bool add_level_scope(int level, std::uint64_t &key, bool &is_closed);
+    void merge_conflict(int level, std::vector<int> &conflict, int floor); // keeps the levels below the level
+    int conflict_target(int level); // the latest level of the conflict, -1 if it's empty
+    // Region node on top has no children left: it and the nodes up to the target level are popped,
+    // the conflict is passed to the target level. Nodes below base_depth stay
+    void backjump(int base_depth);
+    bool is_known_nogood(int region_idx); // the board around the region is the scope of a learned nogood
+
+    // =-=-= propagation.cpp =-=-=
+    // Number of free cells the region can grow into, exit is set to one of them
+    int count_exits(int region_idx, CellIdx &exit);
+    void enqueue_region(int region_idx);
+    void enqueue_regions_near(int region_idx); // regions that own cells within distance 2 from the region
+    // Bounded flood fill: false if the free cells the region can still use (with the unfinished regions
+    // of the same value it can merge) are fewer than the cells it needs. Stops as soon as there are enough
+    bool can_reach_target(int region_idx);
+    void clear_propagation_queue(); // queue is left empty for the next propagation
+
+    // Connected area of free cells has to fit all unfinished regions that can grow only into it.
+    // Returns false if they need more cells than the area has. Area bigger than the limit is accepted
+    bool check_area(CellIdx start, int limit);
+    bool check_areas_near(int region_idx); // areas adjacent to the region
+    bool check_all_areas();
+    // Grows queued regions that have only one exit until nothing changes, updates keys of the others.
+    // Returns false on contradiction
+    bool propagate();
+
+public:
+    Solver(Board &board);
+    Solver(Board &board, SolverContext &context); // state is kept in the context, it's cleared by start
+
+    // Checks the clues, creates regions and propagates constraints.
+    // Returns 1 if solved, 0 if no solution, -1 if the search is needed
+    int start();
+    bool search_from_root(); // after the start returned -1. Returns true if some solution was found
+    bool solve();
+    void set_solution_limit(int solution_limit); // before the start, the search stops at the first solution by default
+    int get_solution_count() { return solution_count; } // after the search, up to the limit
+    // Free cells and unfinished regions connected to each other make the component, the completed regions
+    // around it separate it from the others. Components share no cell the search can fill, so they are
+    // solved one by one (see solve_components): the cost is the sum of their costs, not the product.
+    // Areas that no region reaches are components of the full fill.
+    // Called after the start returned -1, components are left in the context. Returns their count
+    int find_components();
+    void set_config(const SearchConfig &config); // before the start
+    void set_failed_states(TranspositionTable *p_failed_states); // before the start
+
+    // =-=-= parallel search =-=-=
+    void set_parallel(ParallelSearch *p_parallel, int thread_idx);
+    // Undoes the previous task and solves the subtree of the task (start has to return -1 first).
+    // Solutions are counted by the shared state, the first one is kept by its thread.
+    // Returns true if the solution limit was reached
+    bool run_task(const SearchTask &task);
+    // Board gets back the first solution if the search went on after it. With the threads, only the thread
+    // that found the first solution of all has it. Returns false if the solver has no first solution
+    bool restore_solution();
+};
+
+// Backtracking engine uses the fixed layout if the board has one of the common sizes. With more than
+// one thread the search tree is split between them (see ParallelSearch), every thread has a copy of the board.
+// Puzzle that is split into components after the start is solved component by component
+// (see Solver::find_components), the threads take the components instead.
+// Portfolio engine runs a configuration on every thread (PORTFOLIO_DEFAULT_SIZE if there is one thread).
+// Exact cover engine falls back to the backtracking one if the puzzle is too big for it
+bool solve(Board &board, SolverEngine engine = SolverEngine::Backtracking, int thread_count = 1);
+
+// Solve with the storage of the calling thread (see SolverContext), other threads have their own
+bool solve(
+    Board &board, SolverContext &context, SolverEngine engine = SolverEngine::Backtracking, int thread_count = 1
+);
+
+// The same search goes on after the first solution until it finds solution_limit of them (2 tells whether
+// the solution is unique). The board gets the first one. Returns the number of solutions, it's the limit
+// if there are at least that many. Components multiply their counts. Portfolio configurations would
+// count the same tree, so its threads split the tree instead
+int count_solutions(
+    Board &board, SolverContext &context, int solution_limit,
+    SolverEngine engine = SolverEngine::Backtracking, int thread_count = 1
+);
 
 #endif
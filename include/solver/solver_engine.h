@@ -0,0 +1,10 @@
+#ifndef SOLVER_ENGINE_H
+#define SOLVER_ENGINE_H
+
+enum class SolverEngine {
+    Backtracking, // see solver.h
+    ExactCover, // see exact_cover.h
+    Portfolio // several configurations of the backtracking race, the first answer wins (see SearchConfig)
+};
+
+#endif
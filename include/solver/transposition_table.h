@@ -0,0 +1,62 @@
+#ifndef TRANSPOSITION_TABLE_H
+#define TRANSPOSITION_TABLE_H
+
+#include "board/coordinate.h"
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+#define TABLE_DEFAULT_MB 8
+#define TABLE_WAYS 4 // entries of the bucket, the key can be in any of them
+#define TABLE_STRIPES 64 // buckets are guarded by the mutex of their stripe
+// States that failed faster are searched again: the lookup is a cache miss, which costs as much as a few steps
+#define TABLE_MIN_COST 32
+
+// Key of the filled cell. The state key is the xor of the keys of all cells filled by the solver, so it's
+// updated in O(1) when the cell is filled or undone. Keys are mixed from the index and the value (splitmix64)
+// instead of read from the random table, they are equally spread and need no memory
+inline std::uint64_t zobrist_key(CellIdx idx, int value) {
+    std::uint64_t key = static_cast<std::uint64_t>(idx) * 128 + value + 0x9E3779B97F4A7C15ull;
+    key = (key ^ (key >> 30)) * 0xBF58476D1CE4E5B9ull;
+    key = (key ^ (key >> 27)) * 0x94D049BB133111EBull;
+    return key ^ (key >> 31);
+}
+
+enum class ReplacementPolicy {
+    Always, // the new state replaces one of the bucket entries
+    KeepCostly // the cheapest entry is replaced, the new state is dropped if it's cheaper than all of them
+};
+
+// Bounded set of the states that were proven unsolvable. Entries of the previous puzzles are
+// outdated by the epoch, so the table is allocated and cleared once for all puzzles of the context.
+// Threads of one puzzle share the table, buckets are locked by stripes
+class TranspositionTable {
+    struct Entry {
+        std::uint64_t key;
+        std::uint32_t epoch; // entry is empty if it isn't the current one
+        std::uint32_t cost; // search steps spent to prove the state
+    };
+
+    std::vector<Entry> entries;
+    std::mutex stripes[TABLE_STRIPES];
+    int max_mb;
+    ReplacementPolicy policy;
+    std::uint32_t epoch;
+    std::atomic<bool> has_entries; // puzzles that don't fail deep never look into the table
+
+public:
+    TranspositionTable();
+
+    // max_mb 0 disables the table. Takes effect from the next puzzle
+    void configure(int max_mb, ReplacementPolicy policy);
+    // Forgets the states of the previous puzzle, memory is allocated at the first call.
+    // Not thread-safe, it's called before the search starts
+    void new_puzzle();
+
+    bool contains(std::uint64_t key);
+    bool is_empty() { return !has_entries.load(std::memory_order_relaxed); } // lookups can be skipped
+    void insert(std::uint64_t key, long long cost);
+};
+
+#endif
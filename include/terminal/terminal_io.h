@@ -5,6 +5,8 @@
 #include "solver/solve_mode.h"
 #include <string_view>
 
+#define TERMINAL_MAX_SIZE 20 // bigger boards don't fit on the screen, use batch mode for them
+
 class Terminal {
     Board *p_board;
     int cell_width;
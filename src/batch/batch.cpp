@@ -0,0 +1,241 @@
+#include "batch/batch.h"
+#include "batch/corpus_reader.h"
+#include "board/binary_format.h"
+#include "board/board.h"
+#include "board/cell.h"
+#include "solver/solver.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+void write_board(std::ostream &out, Board &board) {
+    out << board.get_rows() << " " << board.get_cols() << "\n";
+    for (int row = 0; row < board.get_rows(); row++) {
+        for (int col = 0; col < board.get_cols(); col++) {
+            if (col != 0) {
+                out << " ";
+            }
+
+            out << board.cell_at(row, col).get_value();
+        }
+
+        out << "\n";
+    }
+}
+
+// !* helper function *!
+// Solutions are counted if the limit is more than 1: the count equal to the limit means at least that many
+void write_text_result(
+    std::ostream &out, int puzzle_num, int solution_count, int solution_limit, double time_ms, Board &board
+) {
+    out << "# puzzle " << puzzle_num << ": ";
+    if (solution_count == 0) {
+        out << "no solution";
+    } else if (solution_limit == 1) {
+        out << "solved";
+    } else if (solution_count == 1) {
+        out << "unique solution";
+    } else {
+        out << solution_count << (solution_count == solution_limit ? "+" : "") << " solutions";
+    }
+    out << " in " << std::fixed << std::setprecision(3) << time_ms << " ms\n";
+
+    if (solution_count > 0) {
+        write_board(out, board);
+    }
+
+    out << "\n";
+}
+
+// !* helper function *!
+void write_binary_result(
+    std::ostream &out, std::vector<unsigned char> &record, int solution_count, double time_ms, Board &board
+) {
+    record.clear();
+    record.push_back(static_cast<unsigned char>(std::min(solution_count, BINARY_MAX_SOLUTION_COUNT)));
+    write_varint(record, static_cast<unsigned int>(time_ms * 1000));
+
+    if (solution_count > 0) {
+        board.write_solution(record);
+    } else {
+        board.write_puzzle(record);
+    }
+
+    out.write(reinterpret_cast<const char *>(record.data()), record.size());
+}
+
+// !* helper function *!
+void solve_boards_thread(
+    std::vector<Board *> &boards, std::vector<BatchResult> &results, SolverContext &context,
+    SolverEngine engine, int search_threads, int solution_limit, std::atomic<int> &next_idx
+) {
+    using clock = std::chrono::steady_clock;
+
+    for (int i = next_idx.fetch_add(1); i < static_cast<int>(boards.size()); i = next_idx.fetch_add(1)) {
+        clock::time_point start = clock::now();
+        boards[i]->create_fixed_cells_list();
+        int solution_count = count_solutions(*boards[i], context, solution_limit, engine, search_threads);
+        std::chrono::duration<double, std::milli> time = clock::now() - start;
+
+        results[i] = { solution_count, time.count() };
+    }
+}
+
+void solve_boards(
+    std::vector<Board *> &boards, std::vector<BatchResult> &results, std::vector<SolverContext> &contexts,
+    SolverEngine engine, int search_threads, int solution_limit
+) {
+    results.resize(boards.size());
+    std::atomic<int> next_idx(0);
+
+    std::vector<std::thread> threads;
+    for (long unsigned int i = 1; i < contexts.size(); i++) {
+        threads.emplace_back(
+            solve_boards_thread, std::ref(boards), std::ref(results), std::ref(contexts[i]),
+            engine, search_threads, solution_limit, std::ref(next_idx)
+        );
+    }
+
+    solve_boards_thread(boards, results, contexts[0], engine, search_threads, solution_limit, next_idx);
+    for (long unsigned int i = 0; i < threads.size(); i++) {
+        threads[i].join();
+    }
+}
+
+// !* helper function *!
+Board *next_board(CorpusReader &reader) {
+    try {
+        return reader.next_board();
+    } catch (const std::runtime_error &error) {
+        throw std::runtime_error(
+            "Puzzle " + std::to_string(reader.get_puzzle_count()) + ": " + error.what()
+        );
+    }
+}
+
+int run_batch(CorpusReader &reader, std::ostream &out, const BatchOptions &options) {
+    using clock = std::chrono::steady_clock;
+
+    if (reader.get_format() == CorpusFormat::BinarySolutions) {
+        throw std::runtime_error("Input contains solutions, not puzzles");
+    }
+
+    if (options.is_binary) {
+        out.write(SOLUTIONS_MAGIC, BINARY_MAGIC_LEN);
+    }
+
+    std::vector<unsigned char> record; // reused for every binary record
+    int failed_count = 0;
+    int unique_count = 0; // puzzles with exactly one solution, counted if the limit is more than 1
+    double total_ms = 0; // wall time of the solves
+
+    // a single thread solves puzzles one by one, so the solutions are written as soon as they are found
+    int batch_threads = options.batch_threads > 1 ? options.batch_threads : 1;
+    int chunk_size = batch_threads > 1 ? batch_threads * BATCH_CHUNK_PER_THREAD : 1;
+    std::vector<SolverContext> contexts(batch_threads);
+    for (int i = 0; i < batch_threads; i++) {
+        contexts[i].failed_states.configure(options.table_mb, options.table_policy);
+    }
+    std::vector<Board *> boards;
+    std::vector<BatchResult> results;
+
+    while (true) {
+        boards.clear();
+        while (static_cast<int>(boards.size()) < chunk_size) {
+            Board *p_board = next_board(reader);
+            if (!p_board) break;
+
+            p_board->fills_all_cells = options.fills_all_cells;
+            boards.push_back(p_board);
+        }
+
+        if (boards.empty()) break;
+
+        clock::time_point start = clock::now();
+        solve_boards(boards, results, contexts, options.engine, options.search_threads, options.solution_limit);
+        std::chrono::duration<double, std::milli> time = clock::now() - start;
+        total_ms += time.count();
+
+        int first_num = reader.get_puzzle_count() - static_cast<int>(boards.size()) + 1;
+        for (long unsigned int i = 0; i < boards.size(); i++) {
+            BatchResult &result = results[i];
+            if (options.is_binary) {
+                write_binary_result(out, record, result.solution_count, result.time_ms, *boards[i]);
+            } else {
+                write_text_result(
+                    out, first_num + static_cast<int>(i), result.solution_count, options.solution_limit,
+                    result.time_ms, *boards[i]
+                );
+            }
+
+            if (result.solution_count == 0) {
+                failed_count++;
+            } else if (result.solution_count == 1) {
+                unique_count++;
+            }
+
+            delete boards[i];
+        }
+    }
+
+    out.flush();
+    int puzzle_count = reader.get_puzzle_count();
+    std::cerr << "Solved " << puzzle_count - failed_count << "/" << puzzle_count
+        << " puzzles in " << std::fixed << std::setprecision(3) << total_ms << " ms";
+    if (total_ms > 0) {
+        std::cerr << " (" << std::setprecision(0) << puzzle_count / total_ms * 1000 << " puzzles/s)";
+    }
+    if (options.solution_limit > 1) {
+        std::cerr << ", " << unique_count << " unique";
+    }
+    std::cerr << std::endl;
+
+    return failed_count;
+}
+
+int convert_corpus(CorpusReader &reader, std::ostream &out) {
+    CorpusFormat format = reader.get_format();
+    if (format == CorpusFormat::Text) {
+        out.write(PUZZLES_MAGIC, BINARY_MAGIC_LEN);
+    }
+
+    std::vector<unsigned char> record;
+    while (Board *p_board = next_board(reader)) {
+        switch (format) {
+            case CorpusFormat::Text:
+                record.clear();
+                p_board->write_puzzle(record);
+                out.write(reinterpret_cast<const char *>(record.data()), record.size());
+                break;
+
+            case CorpusFormat::BinaryPuzzles:
+                write_board(out, *p_board);
+                out << "\n";
+                break;
+
+            case CorpusFormat::BinarySolutions: {
+                // the record keeps the count, but not the limit it was counted to: 1 reads as solved,
+                // only the biggest count that fits is known to be a lower bound
+                int solution_count = reader.get_last_solution_count();
+                int solution_limit = solution_count > 1 ? BINARY_MAX_SOLUTION_COUNT : 1;
+                write_text_result(
+                    out, reader.get_puzzle_count(), solution_count, solution_limit,
+                    reader.get_last_solve_time_us() / 1000.0, *p_board
+                );
+                break;
+            }
+        }
+
+        delete p_board;
+    }
+
+    out.flush();
+    return reader.get_puzzle_count();
+}
@@ -0,0 +1,281 @@
+#include "batch/corpus_reader.h"
+#include "board/binary_format.h"
+#include "board/board.h"
+#include "board/cell.h"
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define MAX_TOKEN_VALUE 1000000000
+
+// !* helper function *!
+std::string string_error(const std::string &msg) {
+    return msg + ": " + std::strerror(errno);
+}
+
+CorpusReader::CorpusReader(const char *path) {
+    if (!path || std::strcmp(path, "-") == 0) {
+        fd = STDIN_FILENO;
+    } else {
+        fd = open(path, O_RDONLY);
+        if (fd == -1) {
+            throw std::runtime_error(string_error("Can't open file " + std::string(path)));
+        }
+    }
+
+    is_mapped = false;
+    data = nullptr;
+    data_size = 0;
+    puzzle_count = 0;
+    last_solution_count = 0;
+    last_solve_time_us = 0;
+
+    struct stat file_stat;
+    if (fstat(fd, &file_stat) == 0 && S_ISREG(file_stat.st_mode) && file_stat.st_size > 0) {
+        void *p_map = mmap(nullptr, file_stat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (p_map != MAP_FAILED) {
+            madvise(p_map, file_stat.st_size, MADV_SEQUENTIAL);
+            is_mapped = true;
+            data = static_cast<char *>(p_map);
+            data_size = file_stat.st_size;
+        }
+    }
+
+    // not a regular file (pipe, terminal) or it can't be mapped
+    if (!is_mapped) {
+        buffer.resize(READ_BUFFER_SIZE);
+    }
+
+    pos = released = data;
+    end = data + data_size;
+
+    try {
+        detect_format();
+    } catch (...) {
+        close_input();
+        throw;
+    }
+}
+
+CorpusReader::~CorpusReader() {
+    close_input();
+}
+
+// =-=-=-=-=-=-=-= Private methods =-=-=-=-=-=-=-=
+void CorpusReader::close_input() {
+    if (is_mapped) {
+        munmap(data, data_size);
+    }
+
+    if (fd != STDIN_FILENO) {
+        close(fd);
+    }
+}
+
+bool CorpusReader::refill() {
+    // the whole file is already available
+    if (is_mapped) return false;
+
+    // move unparsed chars to the start, grow buffer if they take all the space
+    size_t kept = end - pos;
+    if (kept != 0) {
+        std::memmove(buffer.data(), pos, kept);
+    }
+    if (kept == buffer.size()) {
+        buffer.resize(buffer.size() * 2);
+    }
+
+    ssize_t read_count;
+    do {
+        read_count = read(fd, buffer.data() + kept, buffer.size() - kept);
+    } while (read_count == -1 && errno == EINTR);
+
+    if (read_count == -1) {
+        throw std::runtime_error(string_error("Can't read the input"));
+    }
+
+    pos = buffer.data();
+    end = pos + kept + read_count;
+    return read_count > 0;
+}
+
+bool CorpusReader::skip_to_token() {
+    bool is_comment = false;
+    while (true) {
+        if (pos == end && !refill()) return false;
+
+        char ch = *pos;
+        if (is_comment) {
+            is_comment = ch != '\n';
+        } else if (ch == '#') {
+            is_comment = true;
+        } else if (ch != ' ' && ch != '\n' && ch != '\t' && ch != '\r') {
+            return true;
+        }
+
+        pos++;
+    }
+}
+
+bool CorpusReader::read_token(int &value) {
+    if (!skip_to_token()) return false;
+
+    if (*pos == '.') {
+        pos++;
+        value = 0;
+        return true;
+    }
+
+    if (*pos < '0' || *pos > '9') {
+        throw std::runtime_error(std::string("Unexpected character '") + *pos + "' in the puzzle");
+    }
+
+    // digits are accumulated right away, so the buffer may be refilled in the middle of the number
+    value = 0;
+    while (pos != end || refill()) {
+        if (*pos < '0' || *pos > '9') break;
+
+        // checked before the multiplication, so the value never overflows
+        int digit = *pos - '0';
+        if (value > (MAX_TOKEN_VALUE - digit) / 10) {
+            throw std::runtime_error("Number is too big");
+        }
+
+        value = value * 10 + digit;
+
+        pos++;
+    }
+
+    return true;
+}
+
+void CorpusReader::detect_format() {
+    format = CorpusFormat::Text;
+    while (end - pos < BINARY_MAGIC_LEN) {
+        if (!refill()) return; // too short for the binary corpus
+    }
+
+    if (std::memcmp(pos, PUZZLES_MAGIC, BINARY_MAGIC_LEN) == 0) {
+        format = CorpusFormat::BinaryPuzzles;
+    } else if (std::memcmp(pos, SOLUTIONS_MAGIC, BINARY_MAGIC_LEN) == 0) {
+        format = CorpusFormat::BinarySolutions;
+    } else {
+        return;
+    }
+
+    pos += BINARY_MAGIC_LEN;
+}
+
+Board *CorpusReader::next_text_board() {
+    int rows, cols;
+    if (!read_token(rows)) return nullptr;
+
+    puzzle_count++;
+    if (!read_token(cols)) {
+        throw std::runtime_error("Puzzle has no number of cols");
+    }
+
+    if (!is_valid_board_size(rows, cols)) {
+        throw std::runtime_error(
+            "Invalid board size " + std::to_string(rows) + "x" + std::to_string(cols)
+        );
+    }
+
+    Board *p_board = new Board(rows, cols);
+    try {
+        for (int row = 0; row < rows; row++) {
+            for (int col = 0; col < cols; col++) {
+                int value;
+                if (!read_token(value)) {
+                    throw std::runtime_error("Puzzle is incomplete");
+                }
+
+                if (value > MAX_CELL_VAL) {
+                    throw std::runtime_error("Invalid cell value " + std::to_string(value));
+                }
+
+                p_board->create_cell(row, col, value, value != 0);
+            }
+        }
+    } catch (...) {
+        delete p_board;
+        throw;
+    }
+
+    return p_board;
+}
+
+Board *CorpusReader::next_binary_board() {
+    if (pos == end && !refill()) return nullptr;
+    puzzle_count++;
+
+    while (true) {
+        const unsigned char *p = reinterpret_cast<const unsigned char *>(pos);
+        const unsigned char *p_end = reinterpret_cast<const unsigned char *>(end);
+
+        try {
+            Board *p_board;
+            if (format == CorpusFormat::BinaryPuzzles) {
+                p_board = Board::read_puzzle(p, p_end);
+            } else {
+                if (p == p_end) {
+                    throw TruncatedDataError();
+                }
+
+                last_solution_count = *p++;
+                last_solve_time_us = read_varint(p, p_end);
+                p_board = last_solution_count > 0 ? Board::read_solution(p, p_end) : Board::read_puzzle(p, p_end);
+            }
+
+            pos = reinterpret_cast<const char *>(p);
+            return p_board;
+        } catch (const TruncatedDataError &) {
+            // record continues in the part of the input that wasn't read yet
+            if (!refill()) throw;
+        }
+    }
+}
+
+void CorpusReader::release_parsed_pages() {
+    if (!is_mapped || pos - released < RELEASE_CHUNK_SIZE) return;
+
+    // data is page aligned, so it's enough to align the size
+    long page_size = sysconf(_SC_PAGESIZE);
+    size_t size = (pos - released) / page_size * page_size;
+    madvise(const_cast<char *>(released), size, MADV_DONTNEED);
+    released += size;
+}
+
+// =-=-=-=-=-=-=-= Public methods =-=-=-=-=-=-=-=
+Board *CorpusReader::next_board() {
+    Board *p_board;
+    if (format == CorpusFormat::Text) {
+        p_board = next_text_board();
+    } else {
+        p_board = next_binary_board();
+    }
+
+    release_parsed_pages();
+    return p_board;
+}
+
+CorpusFormat CorpusReader::get_format() {
+    return format;
+}
+
+int CorpusReader::get_puzzle_count() {
+    return puzzle_count;
+}
+
+int CorpusReader::get_last_solution_count() {
+    return last_solution_count;
+}
+
+int CorpusReader::get_last_solve_time_us() {
+    return last_solve_time_us;
+}
@@ -0,0 +1,151 @@
+#include "board/binary_format.h"
+#include "board/board.h"
+#include "board/cell.h"
+#include <memory>
+#include <string>
+
+TruncatedDataError::TruncatedDataError() : std::runtime_error("Record is truncated") {}
+
+void write_varint(std::vector<unsigned char> &out, unsigned int value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<unsigned char>(value | 0x80));
+        value >>= 7;
+    }
+
+    out.push_back(static_cast<unsigned char>(value));
+}
+
+void write_svarint(std::vector<unsigned char> &out, int value) {
+    unsigned int zigzag = (static_cast<unsigned int>(value) << 1) ^ static_cast<unsigned int>(value >> 31);
+    write_varint(out, zigzag);
+}
+
+unsigned int read_varint(const unsigned char *&pos, const unsigned char *end) {
+    unsigned int value = 0;
+    for (int shift = 0; shift < 35; shift += 7) {
+        if (pos == end) {
+            throw TruncatedDataError();
+        }
+
+        unsigned char byte = *pos++;
+        if (shift == 28 && (byte & 0x70)) {
+            throw std::runtime_error("Varint is too large");
+        }
+
+        value |= static_cast<unsigned int>(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) return value;
+    }
+
+    throw std::runtime_error("Varint is too long");
+}
+
+int read_svarint(const unsigned char *&pos, const unsigned char *end) {
+    unsigned int zigzag = read_varint(pos, end);
+    return static_cast<int>(zigzag >> 1) ^ -static_cast<int>(zigzag & 1);
+}
+
+void Board::write_puzzle(std::vector<unsigned char> &out) {
+    write_varint(out, rows);
+    write_varint(out, cols);
+
+    // clue bitmap
+    size_t bitmap_start = out.size();
+    out.resize(bitmap_start + (rows * cols + 7) / 8, 0);
+    for (int i = 0; i < rows * cols; i++) {
+        if (cell_at(i / cols, i % cols).get_is_fixed()) {
+            out[bitmap_start + i / 8] |= 1 << (i % 8);
+        }
+    }
+
+    for (int i = 0; i < rows * cols; i++) {
+        Cell &cell = cell_at(i / cols, i % cols);
+        if (cell.get_is_fixed()) {
+            write_varint(out, cell.get_value());
+        }
+    }
+}
+
+void Board::write_solution(std::vector<unsigned char> &out) {
+    write_puzzle(out);
+
+    for (int i = 0; i < rows * cols; i++) {
+        Cell &cell = cell_at(i / cols, i % cols);
+        if (!cell.get_is_fixed()) {
+            write_varint(out, cell.get_value());
+        }
+    }
+
+    for (int i = 0; i < rows * cols; i++) {
+        write_svarint(out, cell_at(i / cols, i % cols).region_id);
+    }
+
+    write_varint(out, result.size());
+    for (long unsigned int i = 0; i < result.size(); i++) {
+        write_varint(out, result.at(i).row * cols + result.at(i).col);
+    }
+}
+
+Board *Board::read_puzzle(const unsigned char *&pos, const unsigned char *end) {
+    unsigned int rows = read_varint(pos, end);
+    unsigned int cols = read_varint(pos, end);
+    if (!is_valid_board_size(rows, cols)) {
+        throw std::runtime_error(
+            "Invalid board size " + std::to_string(rows) + "x" + std::to_string(cols)
+        );
+    }
+
+    int cell_count = rows * cols;
+    const unsigned char *bitmap = pos;
+    if (end - pos < (cell_count + 7) / 8) {
+        throw TruncatedDataError();
+    }
+    pos += (cell_count + 7) / 8;
+
+    std::unique_ptr<Board> p_board(new Board(rows, cols));
+    for (int i = 0; i < cell_count; i++) {
+        if (!(bitmap[i / 8] & (1 << (i % 8)))) continue;
+
+        unsigned int value = read_varint(pos, end);
+        if (value == 0 || value > MAX_CELL_VAL) {
+            throw std::runtime_error("Invalid cell value " + std::to_string(value));
+        }
+
+        p_board->create_cell(i / cols, i % cols, value, true);
+    }
+
+    return p_board.release();
+}
+
+Board *Board::read_solution(const unsigned char *&pos, const unsigned char *end) {
+    std::unique_ptr<Board> p_board(read_puzzle(pos, end));
+    int cols = p_board->cols;
+    int cell_count = p_board->rows * cols;
+
+    for (int i = 0; i < cell_count; i++) {
+        Cell &cell = p_board->cell_at(i / cols, i % cols);
+        if (cell.get_is_fixed()) continue;
+
+        unsigned int value = read_varint(pos, end);
+        if (value > MAX_CELL_VAL) {
+            throw std::runtime_error("Invalid cell value " + std::to_string(value));
+        }
+
+        cell.set_value(value);
+    }
+
+    for (int i = 0; i < cell_count; i++) {
+        p_board->cell_at(i / cols, i % cols).region_id = read_svarint(pos, end);
+    }
+
+    unsigned int result_size = read_varint(pos, end);
+    for (unsigned int i = 0; i < result_size; i++) {
+        unsigned int idx = read_varint(pos, end);
+        if (idx >= static_cast<unsigned int>(cell_count)) {
+            throw std::runtime_error("Invalid cell index");
+        }
+
+        p_board->result.push_back(Coord(idx / cols, idx % cols));
+    }
+
+    return p_board.release();
+}
@@ -0,0 +1,208 @@
+#include "board/bitboard.h"
+#include "board/cell.h"
+
+BitBoard::BitBoard(Board &board) {
+    stride = board.get_adj_offsets()[2];
+    words.assign((board.get_grid_size() + BITBOARD_WORD_BITS - 1) / BITBOARD_WORD_BITS, 0);
+    is_pending.assign(words.size(), 0);
+    low_word = static_cast<int>(words.size());
+    high_word = -1;
+}
+
+// =-=-=-=-=-=-=-= Private methods =-=-=-=-=-=-=-=
+std::uint64_t BitBoard::shifted_word(int word_idx, int shift) {
+    int word_count = static_cast<int>(words.size());
+    std::uint64_t word = 0;
+
+    if (shift >= 0) {
+        int src = word_idx - shift / BITBOARD_WORD_BITS;
+        int bit_shift = shift % BITBOARD_WORD_BITS;
+        if (src >= 0 && src < word_count) {
+            word = words[src] << bit_shift;
+        }
+        if (bit_shift != 0 && src - 1 >= 0 && src - 1 < word_count) {
+            word |= words[src - 1] >> (BITBOARD_WORD_BITS - bit_shift);
+        }
+    } else {
+        int src = word_idx + -shift / BITBOARD_WORD_BITS;
+        int bit_shift = -shift % BITBOARD_WORD_BITS;
+        if (src >= 0 && src < word_count) {
+            word = words[src] >> bit_shift;
+        }
+        if (bit_shift != 0 && src + 1 >= 0 && src + 1 < word_count) {
+            word |= words[src + 1] << (BITBOARD_WORD_BITS - bit_shift);
+        }
+    }
+
+    return word;
+}
+
+std::uint64_t BitBoard::grown_word(int word_idx, std::uint64_t mask) {
+    std::uint64_t word = shifted_word(word_idx, 1) | shifted_word(word_idx, -1);
+    word |= shifted_word(word_idx, stride) | shifted_word(word_idx, -stride);
+    word = (word | words[word_idx]) & mask;
+
+    // the row inside the word is filled at once (occluded fill: every step doubles the distance)
+    std::uint64_t up = word;
+    std::uint64_t down = word;
+    std::uint64_t up_mask = mask;
+    std::uint64_t down_mask = mask;
+    for (int step = 1; step < BITBOARD_WORD_BITS; step *= 2) {
+        up |= up_mask & (up << step);
+        up_mask &= up_mask << step;
+        down |= down_mask & (down >> step);
+        down_mask &= down_mask >> step;
+    }
+
+    return up | down;
+}
+
+void BitBoard::push_pending(int word_idx) {
+    if (word_idx < 0 || word_idx >= static_cast<int>(words.size()) || is_pending[word_idx]) return;
+
+    is_pending[word_idx] = 1;
+    pending_words.push_back(word_idx);
+}
+
+void BitBoard::push_pending_adjs(int word_idx) {
+    // bits of the word move into these words when they are shifted by 1 or by the stride
+    int word_shift = stride / BITBOARD_WORD_BITS;
+    push_pending(word_idx - 1);
+    push_pending(word_idx + 1);
+    push_pending(word_idx - word_shift);
+    push_pending(word_idx - word_shift - 1);
+    push_pending(word_idx + word_shift);
+    push_pending(word_idx + word_shift + 1);
+}
+
+void BitBoard::update_range() {
+    while (low_word <= high_word && words[low_word] == 0) {
+        low_word++;
+    }
+
+    while (high_word >= low_word && words[high_word] == 0) {
+        high_word--;
+    }
+
+    if (low_word > high_word) {
+        low_word = static_cast<int>(words.size());
+        high_word = -1;
+    }
+}
+
+// =-=-=-=-=-=-=-= Public methods =-=-=-=-=-=-=-=
+void BitBoard::set(CellIdx idx) {
+    int word_idx = idx / BITBOARD_WORD_BITS;
+    words[word_idx] |= std::uint64_t(1) << (idx % BITBOARD_WORD_BITS);
+
+    if (word_idx < low_word) {
+        low_word = word_idx;
+    }
+    if (word_idx > high_word) {
+        high_word = word_idx;
+    }
+}
+
+void BitBoard::clear() {
+    for (int i = low_word; i <= high_word; i++) {
+        words[i] = 0;
+    }
+
+    low_word = static_cast<int>(words.size());
+    high_word = -1;
+}
+
+void BitBoard::set_free_cells(Board &board) {
+    clear();
+    for (int row = 0; row < board.get_rows(); row++) {
+        for (int col = 0; col < board.get_cols(); col++) {
+            CellIdx idx = board.idx_of(row, col);
+            if (board.at(idx).get_value() == 0 && board.at(idx).region_id == -1) {
+                set(idx);
+            }
+        }
+    }
+}
+
+int BitBoard::count() const {
+    int count = 0;
+    for (int i = low_word; i <= high_word; i++) {
+        count += __builtin_popcountll(words[i]);
+    }
+
+    return count;
+}
+
+int BitBoard::next_cell(CellIdx start) const {
+    int word_idx = start / BITBOARD_WORD_BITS;
+    std::uint64_t word = 0;
+    if (word_idx < low_word) {
+        word_idx = low_word;
+        word = word_idx <= high_word ? words[word_idx] : 0;
+    } else if (word_idx <= high_word) {
+        word = words[word_idx] & (~std::uint64_t(0) << (start % BITBOARD_WORD_BITS));
+    }
+
+    while (word == 0) {
+        word_idx++;
+        if (word_idx > high_word) return -1;
+
+        word = words[word_idx];
+    }
+
+    return word_idx * BITBOARD_WORD_BITS + __builtin_ctzll(word);
+}
+
+void BitBoard::remove(const BitBoard &other) {
+    // only the range of the other set is touched, so removing small sets is cheap
+    int begin = low_word > other.low_word ? low_word : other.low_word;
+    int end = high_word < other.high_word ? high_word : other.high_word;
+    for (int i = begin; i <= end; i++) {
+        words[i] &= ~other.words[i];
+    }
+
+    update_range();
+}
+
+void BitBoard::append_cells(std::vector<CellIdx> &out) const {
+    for (int i = low_word; i <= high_word; i++) {
+        std::uint64_t word = words[i];
+        while (word != 0) {
+            out.push_back(i * BITBOARD_WORD_BITS + __builtin_ctzll(word));
+            word &= word - 1;
+        }
+    }
+}
+
+void BitBoard::flood(const BitBoard &mask) {
+    for (int i = low_word; i <= high_word; i++) {
+        words[i] &= mask.words[i];
+    }
+
+    update_range();
+    for (int i = low_word; i <= high_word; i++) {
+        if (words[i] != 0) {
+            push_pending(i);
+            push_pending_adjs(i);
+        }
+    }
+
+    while (!pending_words.empty()) {
+        int word_idx = pending_words.back();
+        pending_words.pop_back();
+        is_pending[word_idx] = 0;
+
+        std::uint64_t word = grown_word(word_idx, mask.words[word_idx]);
+        if (word == words[word_idx]) continue;
+
+        words[word_idx] = word;
+        if (word_idx < low_word) {
+            low_word = word_idx;
+        }
+        if (word_idx > high_word) {
+            high_word = word_idx;
+        }
+
+        push_pending_adjs(word_idx);
+    }
+}
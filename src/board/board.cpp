@@ -1,5 +1,6 @@
 #include "board/board.h"
 #include "solver/utils.h"
+#include <new>
 #include <stdexcept>
 
 Board::Board(int rows, int cols) {
@@ -7,28 +8,53 @@ Board::Board(int rows, int cols) {
         throw std::invalid_argument("Board dimensions must be greater than 0");
     }
 
+    if (!is_valid_board_size(rows, cols)) {
+        throw std::invalid_argument("Board is too big");
+    }
+
     this->rows = rows;
     this->cols = cols;
+    this->stride = cols + 1;
     this->region_count = 0;
-    this->board = new Cell*[rows];
-    for (int i = 0; i < rows; i++) {
-        this->board[i] = new Cell[cols];
+    this->fills_all_cells = false;
+
+    adj_offsets[0] = -stride; // up
+    adj_offsets[1] = 1; // right
+    adj_offsets[2] = stride; // down
+    adj_offsets[3] = -1; // left
+
+    int grid_size = get_grid_size();
+    void *p_memory = ::operator new[](grid_size * sizeof(Cell), std::align_val_t(CACHE_LINE_SIZE));
+    this->cells = static_cast<Cell *>(p_memory);
+    for (int i = 0; i < grid_size; i++) {
+        new (&this->cells[i]) Cell(0, true);
+        this->cells[i].region_id = BORDER_REGION_ID;
     }
 
-    // fill coordinates
     for (int row = 0; row < rows; row++) {
         for (int col = 0; col < cols; col++) {
-            this->create_cell(row, col, 0);
+            this->cells[idx_of(row, col)] = Cell(); // empty cell
         }
     }
 }
 
 Board::~Board() {
-    for (int i = 0; i < this->rows; i++) {
-        delete[] this->board[i];
+    // cells are trivially destructible
+    ::operator delete[](this->cells, std::align_val_t(CACHE_LINE_SIZE));
+}
+
+void Board::copy_from(Board &other) {
+    // cells are trivially copyable, sentinels are copied too
+    int grid_size = get_grid_size();
+    for (int i = 0; i < grid_size; i++) {
+        cells[i] = other.cells[i];
     }
 
-    delete[] this->board;
+    region_count = other.region_count;
+    values_on_board = other.values_on_board;
+    fixed_cells = other.fixed_cells;
+    result = other.result;
+    fills_all_cells = other.fills_all_cells;
 }
 
 int Board::get_rows() {
@@ -45,7 +71,7 @@ void Board::create_cell(int row, int col, int value, bool is_fixed) {
     }
     
     Cell &cell = this->cell_at(row, col);
-    cell = Cell(row, col, value, is_fixed);
+    cell = Cell(value, is_fixed);
 }
 
 Cell &Board::cell_at(int row, int col) {
@@ -53,13 +79,25 @@ Cell &Board::cell_at(int row, int col) {
         throw std::out_of_range("Index out of range!");
     }
 
-    return this->board[row][col];
+    return this->cells[idx_of(row, col)];
 }
 
 Cell &Board::cell_at(Coord coord) {
     return this->cell_at(coord.row, coord.col);
 }
 
+Coord Board::coord_of(CellIdx idx) {
+    return Coord(idx / stride - 1, idx % stride);
+}
+
+Coord Board::coord_of(Cell &cell) {
+    return coord_of(idx_of(cell));
+}
+
+int Board::get_grid_size() {
+    return (rows + 2) * stride;
+}
+
 Region Board::create_region(int target_size) {
     Region region(region_count, target_size);
     region_count++;
@@ -68,7 +106,7 @@ Region Board::create_region(int target_size) {
 }
 
 void Board::create_fixed_cells_list() {
-    fixed_cell_coords.clear();
+    fixed_cells.clear();
     result.clear();
 
     for (int row = 0; row < rows; row++) {
@@ -82,7 +120,7 @@ void Board::create_fixed_cells_list() {
                     continue;
                 }
 
-                fixed_cell_coords.push_back(Coord(row, col));
+                fixed_cells.push_back(idx_of(row, col));
             }
         }
     }
@@ -102,3 +140,6 @@ void Board::fill_values_on_board() {
     }
 }
 
+bool is_valid_board_size(long long rows, long long cols) {
+    return rows > 0 && cols > 0 && rows * cols <= BOARD_MAX_CELLS;
+}
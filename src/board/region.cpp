@@ -1,5 +1,4 @@
 #include "board/region.h"
-#include <stdexcept>
 
 Region::Region(int id, int target_size) {
     this->id = id;
@@ -15,48 +14,29 @@ int Region::get_target_size() {
 }
 
 int Region::get_size() {
-    return static_cast<int>(coords.size());
+    return static_cast<int>(cells.size());
 }
 
-void Region::push(const Coord &coord) {
-    coords.push_back(coord);
+void Region::push(CellIdx idx) {
+    cells.push_back(idx);
 }
 
-Coord Region::pop() {
-    if (coords.size() == 0) {
-        return Coord(-1, -1);
+CellIdx Region::pop() {
+    if (cells.size() == 0) {
+        return -1;
     }
     
-    Coord coord = coords.at(coords.size() - 1);
-    coords.pop_back();
+    CellIdx idx = cells.back();
+    cells.pop_back();
  
-    return coord;
+    return idx;
 }
 
-Coord Region::coord_at(int idx) {
-    if (idx < 0 || idx >= static_cast<int>(coords.size())) {
-        throw std::out_of_range("Index out of range!");
-    }
-
-    return coords.at(idx);
+CellIdx Region::cell_at(int pos) {
+    return cells[pos];
 }
 
-void Region::remove_at(int idx) {
-    // remove last
-    int size = static_cast<int>(coords.size());
-    if (idx < 0 || idx >= size) {
-        throw std::out_of_range("Index out of range!");
-    }
-
-    if (idx == size - 1) {
-        coords.pop_back();
-        return;
-    }
-
-    // if not last => shift items left and remove last
-    for (int i = idx; i < size - 1; i++) {
-        coords.at(i) = coords.at(i + 1);
-    }
-
-    coords.pop_back();
+void Region::reset(int target_size) {
+    this->target_size = target_size;
+    cells.clear();
 }
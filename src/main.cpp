@@ -3,9 +3,113 @@
 #include "terminal/terminal_io.h"
 #include "solver/solver.h"
 #include "solver/solve_mode.h"
+#include "solver/solver_engine.h"
+#include "batch/batch.h"
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
 #include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+// !* helper function *!
+void print_usage(const char *program) {
+    std::cerr << "Usage:\n"
+        << "  " << program << "                               solve the board in the terminal\n"
+        << "  " << program << " --batch [file] [--binary] [--fill-all] [--exact-cover | --portfolio] [--search-threads N]\n"
+        << "          [--threads N] [--table-mb N] [--table-policy always|costly] [--count N]\n"
+        << "                                      solve puzzles from the file (or stdin)\n"
+        << "  " << program << " --convert [in] [out]          convert text puzzles into binary and back\n";
+}
+
+// !* helper function *!
+int parse_thread_count(const char *arg) {
+    // 0 or less - one thread per core
+    int count = std::atoi(arg);
+    return count > 0 ? count : std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+}
+
+// !* helper function *!
+bool is_table_policy(const std::string &arg) {
+    return arg == "always" || arg == "costly";
+}
+
+// Headless modes. Read puzzles from the file (or stdin) and write results to stdout (or file)
+int batch_main(int argc, char **argv) {
+    std::string mode = argv[1];
+    const char *in_path = nullptr;
+    const char *out_path = nullptr;
+    BatchOptions options;
+
+    for (int i = 2; i < argc; i++) {
+        std::string arg = argv[i];
+        if (mode == "--batch" && arg == "--binary") {
+            options.is_binary = true;
+        } else if (mode == "--batch" && arg == "--fill-all") {
+            options.fills_all_cells = true;
+        } else if (mode == "--batch" && arg == "--exact-cover") {
+            options.engine = SolverEngine::ExactCover;
+        } else if (mode == "--batch" && arg == "--portfolio") {
+            options.engine = SolverEngine::Portfolio;
+        } else if (mode == "--batch" && arg == "--search-threads" && i + 1 < argc) {
+            options.search_threads = parse_thread_count(argv[++i]);
+        } else if (mode == "--batch" && arg == "--threads" && i + 1 < argc) {
+            options.batch_threads = parse_thread_count(argv[++i]);
+        } else if (mode == "--batch" && arg == "--table-mb" && i + 1 < argc) {
+            options.table_mb = std::max(0, std::atoi(argv[++i]));
+        } else if (mode == "--batch" && arg == "--table-policy" && i + 1 < argc && is_table_policy(argv[i + 1])) {
+            std::string policy = argv[++i];
+            options.table_policy = policy == "always" ? ReplacementPolicy::Always : ReplacementPolicy::KeepCostly;
+        } else if (mode == "--batch" && arg == "--count" && i + 1 < argc) {
+            options.solution_limit = std::max(1, std::atoi(argv[++i]));
+        } else if (!in_path) {
+            in_path = argv[i];
+        } else if (mode == "--convert" && !out_path) {
+            out_path = argv[i];
+        } else {
+            print_usage(argv[0]);
+            return 2;
+        }
+    }
+
+    std::ios::sync_with_stdio(false);
+
+    try {
+        CorpusReader reader(in_path);
+        std::ofstream out_file;
+        if (out_path) {
+            out_file.open(out_path, std::ios::binary);
+            if (!out_file) {
+                std::cerr << "Can't open file " << out_path << "\n";
+                return 2;
+            }
+        }
+
+        std::ostream &out = out_path ? out_file : std::cout;
+        if (mode == "--convert") {
+            convert_corpus(reader, out);
+            return 0;
+        }
+
+        return run_batch(reader, out, options) == 0 ? 0 : 1;
+    } catch (const std::exception &error) {
+        std::cerr << "Error: " << error.what() << "\n";
+        return 2;
+    }
+}
+
+int main(int argc, char **argv) {
+    if (argc > 1) {
+        std::string mode = argv[1];
+        if (mode == "--batch" || mode == "--convert") {
+            return batch_main(argc, argv);
+        }
+
+        print_usage(argv[0]);
+        return 2;
+    }
 
-int main(void) {
     Terminal tm;
  
     int rows, cols;
@@ -0,0 +1,440 @@
+#include "solver/exact_cover.h"
+#include "board/cell.h"
+#include "solver/manual_solving.h"
+#include "solver/utils.h"
+#include <vector>
+
+ExactCoverSolver::ExactCoverSolver(Board &board) : board(board), visited_count(0) {}
+
+// =-=-=-=-=-=-=-= Private methods =-=-=-=-=-=-=-=
+bool ExactCoverSolver::create_groups() {
+    const int *offsets = board.get_adj_offsets();
+    group_of.assign(board.get_grid_size(), -1);
+
+    for (long unsigned int i = 0; i < board.fixed_cells.size(); i++) {
+        CellIdx start = board.fixed_cells[i];
+        int value = board.at(start).get_value();
+        if (value == 1 || group_of[start] != -1) continue; // single cells are already solved
+
+        // flood fill over the clues with the same value, group cells are used as a queue
+        Region group(static_cast<int>(groups.size()), value);
+        group.push(start);
+        group_of[start] = group.get_id();
+        for (int j = 0; j < group.get_size(); j++) {
+            CellIdx idx = group.cell_at(j);
+            for (int dir = 0; dir < 4; dir++) {
+                CellIdx adj_idx = idx + offsets[dir];
+                if (group_of[adj_idx] != -1 || board.at(adj_idx).get_value() != value) continue;
+
+                group_of[adj_idx] = group.get_id();
+                group.push(adj_idx);
+            }
+        }
+
+        if (group.get_size() > value) return false;
+        groups.push_back(group);
+    }
+
+    return true;
+}
+
+bool ExactCoverSolver::is_allowed(CellIdx idx, int value) {
+    Cell &cell = board.at(idx);
+    if (cell.region_id == BORDER_REGION_ID) return false;
+
+    int cell_value = cell.get_value();
+    return cell_value == 0 || cell_value == value;
+}
+
+void ExactCoverSolver::push_shape_cells(CellIdx idx) {
+    int group_idx = group_of[idx];
+    if (group_idx == -1) {
+        shape.push_back(idx);
+        is_in_shape[idx] = 1;
+        return;
+    }
+
+    Region &group = groups[group_idx];
+    for (int i = 0; i < group.get_size(); i++) {
+        shape.push_back(group.cell_at(i));
+        is_in_shape[group.cell_at(i)] = 1;
+    }
+}
+
+void ExactCoverSolver::add_untried_adjs(ShapeFrame &frame, int first_member, int value) {
+    const int *offsets = board.get_adj_offsets();
+
+    for (int i = first_member; i < static_cast<int>(shape.size()); i++) {
+        for (int dir = 0; dir < 4; dir++) {
+            CellIdx idx = shape[i] + offsets[dir];
+            if (is_seen[idx] || !is_allowed(idx, value)) continue;
+
+            int group_idx = group_of[idx];
+            if (group_idx == -1) {
+                is_seen[idx] = 1;
+                seen_trail.push_back(idx);
+            } else {
+                Region &group = groups[group_idx];
+                for (int j = 0; j < group.get_size(); j++) {
+                    is_seen[group.cell_at(j)] = 1;
+                    seen_trail.push_back(group.cell_at(j));
+                }
+            }
+
+            untried.push_back(idx);
+        }
+    }
+
+    frame.untried_end = static_cast<int>(untried.size());
+}
+
+void ExactCoverSolver::pop_shape_frame() {
+    ShapeFrame &frame = frames.back();
+
+    while (static_cast<int>(seen_trail.size()) > frame.seen_mark) {
+        is_seen[seen_trail.back()] = 0;
+        seen_trail.pop_back();
+    }
+
+    while (static_cast<int>(shape.size()) > frame.shape_mark) {
+        is_in_shape[shape.back()] = 0;
+        shape.pop_back();
+    }
+
+    untried.resize(frame.untried_begin);
+    frames.pop_back();
+}
+
+bool ExactCoverSolver::is_legal_shape(int value) {
+    const int *offsets = board.get_adj_offsets();
+
+    for (long unsigned int i = 0; i < shape.size(); i++) {
+        for (int dir = 0; dir < 4; dir++) {
+            CellIdx idx = shape[i] + offsets[dir];
+            int group_idx = group_of[idx];
+            if (group_idx != -1 && !is_in_shape[idx] && groups[group_idx].get_target_size() == value) {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+void ExactCoverSolver::add_placement(int value) {
+    placements.push_back({ value, static_cast<int>(placement_cells.size()) });
+    placement_cells.insert(placement_cells.end(), shape.begin(), shape.end());
+}
+
+bool ExactCoverSolver::enumerate_placements(int group_idx) {
+    Region &group = groups[group_idx];
+    int value = group.get_target_size();
+
+    frames.push_back({ 0, 0, 0, 0, 0 });
+    push_shape_cells(group.cell_at(0));
+    for (int i = 0; i < group.get_size(); i++) {
+        is_seen[group.cell_at(i)] = 1;
+        seen_trail.push_back(group.cell_at(i));
+    }
+
+    if (group.get_size() == value) {
+        if (is_legal_shape(value)) {
+            add_placement(value);
+        }
+
+        pop_shape_frame();
+        return true;
+    }
+
+    add_untried_adjs(frames.back(), 0, value);
+    while (!frames.empty()) {
+        ShapeFrame &frame = frames.back();
+        if (frame.untried_pos == frame.untried_end) {
+            pop_shape_frame();
+            continue;
+        }
+
+        CellIdx idx = untried[frame.untried_pos];
+        frame.untried_pos++;
+
+        // shapes with the group of the smaller index were enumerated from that group
+        int added_group_idx = group_of[idx];
+        if (added_group_idx != -1 && added_group_idx < group_idx) continue;
+
+        int added_size = added_group_idx == -1 ? 1 : groups[added_group_idx].get_size();
+        int size = static_cast<int>(shape.size()) + added_size;
+        if (size > value) continue;
+
+        visited_count++;
+        if (visited_count > EXACT_COVER_MAX_NODES) {
+            while (!frames.empty()) {
+                pop_shape_frame();
+            }
+
+            return false;
+        }
+
+        // parent is copied before the push, it may move the frames
+        int parent_pos = frame.untried_pos;
+        int parent_end = frame.untried_end;
+        int untried_size = static_cast<int>(untried.size());
+        frames.push_back({
+            untried_size, untried_size, untried_size,
+            static_cast<int>(shape.size()), static_cast<int>(seen_trail.size())
+        });
+        push_shape_cells(idx);
+
+        if (size == value) {
+            if (is_legal_shape(value)) {
+                add_placement(value);
+            }
+
+            pop_shape_frame();
+            continue;
+        }
+
+        for (int i = parent_pos; i < parent_end; i++) {
+            CellIdx untried_idx = untried[i];
+            untried.push_back(untried_idx);
+        }
+
+        add_untried_adjs(frames.back(), frames.back().shape_mark, value);
+    }
+
+    return true;
+}
+
+int ExactCoverSolver::add_column(bool is_primary) {
+    int column = static_cast<int>(nodes.size());
+    DlxNode header = { column, column, column, column, column, 0 };
+
+    // secondary columns are never chosen, so they aren't linked into the root row
+    if (is_primary) {
+        header.left = nodes[0].left;
+        header.right = 0;
+        nodes[header.left].right = column;
+        nodes[0].left = column;
+    }
+
+    nodes.push_back(header);
+    return column;
+}
+
+void ExactCoverSolver::add_row_node(int column, int placement_idx, int &first_node) {
+    int node = static_cast<int>(nodes.size());
+    DlxNode row_node = { node, node, nodes[column].up, column, column, placement_idx };
+
+    if (first_node == -1) {
+        first_node = node;
+    } else {
+        row_node.left = nodes[first_node].left;
+        row_node.right = first_node;
+        nodes[row_node.left].right = node;
+        nodes[first_node].left = node;
+    }
+
+    nodes[row_node.up].down = node;
+    nodes[column].up = node;
+    nodes[column].data++;
+    nodes.push_back(row_node);
+}
+
+int ExactCoverSolver::edge_column(CellIdx idx_a, CellIdx idx_b, int value) {
+    CellIdx low = idx_a < idx_b ? idx_a : idx_b;
+    CellIdx high = idx_a < idx_b ? idx_b : idx_a;
+    long long edge = static_cast<long long>(low) * 2 + (high - low == 1 ? 0 : 1);
+    long long key = edge * (MAX_CELL_VAL + 1) + value;
+
+    std::unordered_map<long long, int>::iterator it = edge_columns.find(key);
+    if (it != edge_columns.end()) return it->second;
+
+    int column = add_column(false);
+    edge_columns[key] = column;
+    return column;
+}
+
+void ExactCoverSolver::add_row(int placement_idx) {
+    Placement &placement = placements[placement_idx];
+    const int *offsets = board.get_adj_offsets();
+    int first_node = -1;
+
+    for (int i = 0; i < placement.value; i++) {
+        is_in_shape[placement_cells[placement.first_cell + i]] = 1;
+    }
+
+    for (int i = 0; i < placement.value; i++) {
+        CellIdx idx = placement_cells[placement.first_cell + i];
+        int group_idx = group_of[idx];
+        if (group_idx == -1) {
+            if (cell_columns[idx] == 0) {
+                cell_columns[idx] = add_column(false);
+            }
+
+            add_row_node(cell_columns[idx], placement_idx, first_node);
+        } else if (groups[group_idx].cell_at(0) == idx) {
+            add_row_node(1 + group_idx, placement_idx, first_node);
+        }
+
+        // pairs inside the placement can't be touched by another placement, its cells are covered already
+        for (int dir = 0; dir < 4; dir++) {
+            CellIdx adj_idx = idx + offsets[dir];
+            if (is_in_shape[adj_idx] || !is_allowed(adj_idx, placement.value)) continue;
+
+            add_row_node(edge_column(idx, adj_idx, placement.value), placement_idx, first_node);
+        }
+    }
+
+    for (int i = 0; i < placement.value; i++) {
+        is_in_shape[placement_cells[placement.first_cell + i]] = 0;
+    }
+}
+
+bool ExactCoverSolver::build_matrix() {
+    nodes.push_back({ 0, 0, 0, 0, 0, 0 });
+    for (long unsigned int i = 0; i < groups.size(); i++) {
+        add_column(true);
+    }
+
+    cell_columns.assign(board.get_grid_size(), 0);
+    for (int i = 0; i < static_cast<int>(placements.size()); i++) {
+        add_row(i);
+        if (static_cast<int>(nodes.size()) > EXACT_COVER_MAX_NODES) return false;
+    }
+
+    return true;
+}
+
+void ExactCoverSolver::cover(int column) {
+    DlxNode &header = nodes[column];
+    nodes[header.right].left = header.left;
+    nodes[header.left].right = header.right;
+
+    for (int row = header.down; row != column; row = nodes[row].down) {
+        for (int node = nodes[row].right; node != row; node = nodes[node].right) {
+            DlxNode &row_node = nodes[node];
+            nodes[row_node.down].up = row_node.up;
+            nodes[row_node.up].down = row_node.down;
+            nodes[row_node.column].data--;
+        }
+    }
+}
+
+void ExactCoverSolver::uncover(int column) {
+    DlxNode &header = nodes[column];
+
+    for (int row = header.up; row != column; row = nodes[row].up) {
+        for (int node = nodes[row].left; node != row; node = nodes[node].left) {
+            DlxNode &row_node = nodes[node];
+            nodes[row_node.column].data++;
+            nodes[row_node.down].up = node;
+            nodes[row_node.up].down = node;
+        }
+    }
+
+    nodes[header.right].left = column;
+    nodes[header.left].right = column;
+}
+
+int ExactCoverSolver::choose_column() {
+    int best = nodes[0].right;
+    for (int column = nodes[best].right; column != 0 && nodes[best].data > 1; column = nodes[column].right) {
+        if (nodes[column].data < nodes[best].data) {
+            best = column;
+        }
+    }
+
+    return best;
+}
+
+bool ExactCoverSolver::next_row(int &column, int &row) {
+    if (chosen.empty()) return false;
+
+    row = chosen.back();
+    chosen.pop_back();
+    column = nodes[row].column;
+    for (int node = nodes[row].left; node != row; node = nodes[node].left) {
+        uncover(nodes[node].column);
+    }
+
+    row = nodes[row].down;
+    return true;
+}
+
+int ExactCoverSolver::search(int solution_limit) {
+    // explicit stack of the chosen rows, the depth is the number of groups
+    int column = 0;
+    int row = 0;
+    bool is_new_level = true;
+    int solution_count = 0;
+
+    while (true) {
+        if (is_new_level && nodes[0].right == 0) {
+            // every group is covered, the search goes on from the next row of the last level
+            if (++solution_count == 1) {
+                fill_result();
+            }
+            if (solution_count == solution_limit || !next_row(column, row)) return solution_count;
+
+            is_new_level = false;
+            continue;
+        }
+
+        if (is_new_level) {
+            column = choose_column();
+            cover(column);
+            row = nodes[column].down;
+        }
+
+        if (row == column) {
+            // all rows of the column were tried, the previous level tries its next row
+            uncover(column);
+            if (!next_row(column, row)) return solution_count;
+
+            is_new_level = false;
+            continue;
+        }
+
+        chosen.push_back(row);
+        for (int node = nodes[row].right; node != row; node = nodes[node].right) {
+            cover(nodes[node].column);
+        }
+
+        is_new_level = true;
+    }
+}
+
+void ExactCoverSolver::fill_result() {
+    // single cells are already in the result
+    for (long unsigned int i = 0; i < chosen.size(); i++) {
+        Placement &placement = placements[nodes[chosen[i]].data];
+        Region region = board.create_region(placement.value);
+
+        for (int j = 0; j < placement.value; j++) {
+            CellIdx idx = placement_cells[placement.first_cell + j];
+            Cell &cell = board.at(idx);
+            cell.set_value(placement.value);
+            cell.region_id = region.get_id();
+            board.result.push_back(board.coord_of(idx));
+        }
+    }
+}
+
+// =-=-=-=-=-=-=-= Public methods =-=-=-=-=-=-=-=
+int ExactCoverSolver::solve(int solution_limit) {
+    if (!validate_single_cells(&board)) return 0;
+    if (!create_groups()) return 0;
+    if (groups.empty()) {
+        fill_empty_board(board);
+        return 1;
+    }
+
+    is_seen.assign(board.get_grid_size(), 0);
+    is_in_shape.assign(board.get_grid_size(), 0);
+    for (int i = 0; i < static_cast<int>(groups.size()); i++) {
+        if (!enumerate_placements(i)) return -1;
+    }
+
+    if (!build_matrix()) return -1;
+
+    return search(solution_limit);
+}
@@ -1,8 +1,9 @@
 #include "solver/manual_solving.h"
+#include "board/bitboard.h"
 #include "board/board.h"
 #include "board/cell.h"
 #include "solver/utils.h"
-#include "solver/coord_queue.h"
+#include <vector>
 
 Board *copy_board(Board &board) {
     Board *p_board = new Board(board.get_rows(), board.get_cols());
@@ -25,17 +26,11 @@ bool validate_single_cells(Board *p_board) {
             if (cell.get_value() != 1) continue;
 
             // p_board->result.push_back(Coord(row, col));
-         
-            Coord adj_coords[4];
-            adj_coords[0] = Coord(row - 1, col); // top
-            adj_coords[1] = Coord(row + 1, col); // bottom
-            adj_coords[2] = Coord(row, col - 1); // left
-            adj_coords[3] = Coord(row, col + 1); // right
+            CellIdx idx = p_board->idx_of(row, col);
+            const int *offsets = p_board->get_adj_offsets();
    
             for (int i = 0; i < 4; i++) {
-                if (!is_coord_valid(*p_board, adj_coords[i])) continue;
-         
-                Cell &adj_cell = p_board->cell_at(adj_coords[i]);
+                Cell &adj_cell = p_board->at(idx + offsets[i]);
                 if (adj_cell.get_value() == 1) {
                     return false;
                 } 
@@ -46,65 +41,54 @@ bool validate_single_cells(Board *p_board) {
     return true;
 }
 
-bool enqueue_adj_cells(Board *p_board, CoordQueue &queue, Cell &cell) {
-    int row = cell.get_coord().row;
-    int col = cell.get_coord().col;
-    Coord adj_coords[4];
-    adj_coords[0] = Coord(row - 1, col); // top
-    adj_coords[1] = Coord(row + 1, col); // bottom
-    adj_coords[2] = Coord(row, col - 1); // left
-    adj_coords[3] = Coord(row, col + 1); // right
-    
-    for (int i = 0; i < 4; i++) {
-        if (!is_coord_valid(*p_board, adj_coords[i])) continue;
-
-        Cell &adj_cell = p_board->cell_at(adj_coords[i]);
-        if (adj_cell.get_value() != cell.get_value()) continue;
-
-        if (adj_cell.region_id != -1 && adj_cell.region_id != cell.region_id) {
-            return false; // invalid region
-        }
+// validate board by filling every region with the flood fill over the cells of its value
+bool validate_regions(Board *p_board) {
+    // masks of all values are built in one pass over the board
+    std::vector<BitBoard> value_masks;
+    std::vector<int> mask_of_value(MAX_CELL_VAL + 1, -1);
+    for (int row = 0; row < p_board->get_rows(); row++) {
+        for (int col = 0; col < p_board->get_cols(); col++) {
+            int value = p_board->cell_at(row, col).get_value();
+            if (value == 0) continue;
 
-        if (adj_cell.region_id == -1) {
-            queue.enqueue(adj_cell.get_coord());
+            if (mask_of_value[value] == -1) {
+                mask_of_value[value] = static_cast<int>(value_masks.size());
+                value_masks.push_back(BitBoard(*p_board));
+            }
+
+            value_masks[mask_of_value[value]].set(p_board->idx_of(row, col));
         }
     }
 
-    return true;
-}
+    BitBoard region_cells(*p_board);
+    std::vector<CellIdx> cells;
 
-// validate board by filling it with BFS
-bool validate_regions(Board *p_board) {
-    int next_cell_idx = get_next_unfilled_fixed_cell_idx(*p_board);
-    if (next_cell_idx == -1) return true; // all regions filled correctly
-
-    Coord next_cell_coord = p_board->fixed_cell_coords.at(next_cell_idx);
-    Cell &cell = p_board->cell_at(next_cell_coord);
-
-    CoordQueue queue;
-    queue.enqueue(cell.get_coord());
-    Region region = p_board->create_region(cell.get_value());
-
-    while (queue.get_size() > 0) {
-        Coord coord = queue.dequeue();
-        Cell &cell = p_board->cell_at(coord);
-        if (cell.region_id != -1) continue; // added second time from other cells
-       
-        cell.region_id = region.get_id();
-        region.push(coord);
-        p_board->result.push_back(coord);
-
-        if (!enqueue_adj_cells(p_board, queue, cell)) {
+    int next_cell_idx = 0;
+    while (true) {
+        next_cell_idx = get_next_unfilled_fixed_cell_idx(*p_board, next_cell_idx);
+        if (next_cell_idx == -1) return true; // all regions filled correctly
+
+        CellIdx start = p_board->fixed_cells[next_cell_idx];
+        int value = p_board->at(start).get_value();
+
+        // region is the whole component of the cells with its value, so it can't touch another one
+        region_cells.clear();
+        region_cells.set(start);
+        region_cells.flood(value_masks[mask_of_value[value]]);
+
+        // overflow or underflow
+        if (region_cells.count() != value) {
             return false;
-        } 
-    }
+        }
 
-    // overflow or underflow
-    if (region.get_size() != region.get_target_size()) {
-        return false;
+        Region region = p_board->create_region(value);
+        cells.clear();
+        region_cells.append_cells(cells);
+        for (long unsigned int i = 0; i < cells.size(); i++) {
+            p_board->at(cells[i]).region_id = region.get_id();
+            p_board->result.push_back(p_board->coord_of(cells[i]));
+        }
     }
-
-    return validate_regions(p_board);
 }
 
 bool is_correctly_solved(Board &board) {
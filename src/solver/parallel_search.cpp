@@ -0,0 +1,114 @@
+#include "solver/parallel_search.h"
+#include <utility>
+
+void TaskDeque::push(SearchTask &&task) {
+    std::lock_guard<std::mutex> lock(mutex);
+    tasks.push_back(std::move(task));
+}
+
+bool TaskDeque::pop(SearchTask &task) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (tasks.empty()) return false;
+
+    task = std::move(tasks.back());
+    tasks.pop_back();
+    return true;
+}
+
+bool TaskDeque::steal(SearchTask &task) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (tasks.empty()) return false;
+
+    task = std::move(tasks.front());
+    tasks.pop_front();
+    return true;
+}
+
+bool TaskDeque::is_empty() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return tasks.empty();
+}
+
+ParallelSearch::ParallelSearch(int thread_count, int solution_limit)
+    : deques(thread_count), is_stopped(false), task_count(0), idle_count(0), solution_count(0),
+    solution_limit(solution_limit), event_count(0) {}
+
+void ParallelSearch::notify_waiting() {
+    {
+        std::lock_guard<std::mutex> lock(wait_mutex);
+        event_count++;
+    }
+
+    wait_signal.notify_all();
+}
+
+void ParallelSearch::push_task(int thread_idx, SearchTask &&task) {
+    // counted before it can be taken, so the count never drops to 0 while the task exists
+    task_count.fetch_add(1);
+    deques[thread_idx].push(std::move(task));
+    notify_waiting();
+}
+
+bool ParallelSearch::next_task(int thread_idx, SearchTask &task) {
+    int thread_count = get_thread_count();
+    idle_count.fetch_add(1);
+
+    // tasks are created only by the running tasks, so no task can appear when the count is 0
+    while (true) {
+        // changes made after the count is read wake the thread, so none of them is missed
+        long long seen_events;
+        {
+            std::lock_guard<std::mutex> lock(wait_mutex);
+            seen_events = event_count;
+        }
+
+        if (get_is_stopped() || task_count.load() == 0) break;
+
+        if (deques[thread_idx].pop(task)) {
+            idle_count.fetch_sub(1);
+            return true;
+        }
+
+        for (int i = 1; i < thread_count; i++) {
+            if (deques[(thread_idx + i) % thread_count].steal(task)) {
+                idle_count.fetch_sub(1);
+                return true;
+            }
+        }
+
+        std::unique_lock<std::mutex> lock(wait_mutex);
+        wait_signal.wait(lock, [&] { return event_count != seen_events; });
+    }
+
+    idle_count.fetch_sub(1);
+    return false;
+}
+
+void ParallelSearch::finish_task() {
+    // the last task finishes the search, other finishes don't change anything for the idle threads
+    if (task_count.fetch_sub(1) == 1) {
+        notify_waiting();
+    }
+}
+
+bool ParallelSearch::wants_task(int thread_idx) {
+    return idle_count.load(std::memory_order_relaxed) > 0 && deques[thread_idx].is_empty();
+}
+
+bool ParallelSearch::stop() {
+    bool is_first = !is_stopped.exchange(true);
+    if (is_first) {
+        notify_waiting();
+    }
+
+    return is_first;
+}
+
+bool ParallelSearch::add_solution() {
+    // the last solution claims the stop, it isn't kept if a thread of the portfolio claimed the failure first.
+    // Solutions found after the stop are over the limit
+    int count = solution_count.fetch_add(1) + 1;
+    if (count == solution_limit && !stop()) return false;
+
+    return count == 1;
+}
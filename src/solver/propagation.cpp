@@ -0,0 +1,324 @@
+#include "solver/solver.h"
+#include "board/cell.h"
+
+// Deductions used here are sound for any order of the search:
+// - region that isn't completed has to grow, so if it can grow only into one cell, the cell is added
+//   (if it can't grow at all, the branch is dead)
+// - cell can't be added if region would overflow together with the regions of the same value it touches,
+//   so completed regions block their neighbours for every region of the same value
+// - adding the cell merges all regions of the same value it touches (see Solver::add_cell)
+// - region has to reach the target size through the cells it can still use (see can_reach_target)
+// - area of free cells has to fit the regions that can grow only into it (see check_area)
+
+template <class Layout>
+int Solver<Layout>::count_exits(int region_idx, CellIdx &exit) {
+    Region &region = regions[region_idx];
+    const int *offsets = layout.get_adj_offsets();
+    int count = 0;
+
+    new_mark_pass(); // cell adjacent to several members is counted once
+    for (int i = 0; i < region.get_size(); i++) {
+        CellIdx member = region.cell_at(i);
+        for (int dir = 0; dir < 4; dir++) {
+            CellIdx idx = member + offsets[dir];
+            if (board.at(idx).region_id != -1 || cell_marks[idx] == mark_stamp) continue;
+
+            cell_marks[idx] = mark_stamp;
+            if (size_after_adding(region_idx, idx) <= region.get_target_size()) {
+                count++;
+                exit = idx;
+            }
+        }
+    }
+
+    return count;
+}
+
+template <class Layout>
+void Solver<Layout>::enqueue_region(int region_idx) {
+    if (is_queued[region_idx]) return;
+
+    is_queued[region_idx] = 1;
+    propagation_queue.push_back(region_idx);
+}
+
+template <class Layout>
+void Solver<Layout>::enqueue_regions_near(int region_idx) {
+    Region &region = regions[region_idx];
+    const int *offsets = layout.get_adj_offsets();
+
+    // distance 2 is reached through the adjacent cells, so indexes never leave the sentinel border
+    for (int i = 0; i < region.get_size(); i++) {
+        CellIdx member = region.cell_at(i);
+        for (int dir = 0; dir < 4; dir++) {
+            CellIdx adj_idx = member + offsets[dir];
+            if (board.at(adj_idx).region_id == BORDER_REGION_ID) continue;
+
+            int adj_region_idx = region_idx_of(adj_idx);
+            if (adj_region_idx != -1) {
+                enqueue_region(adj_region_idx);
+            }
+
+            for (int next_dir = 0; next_dir < 4; next_dir++) {
+                int near_region_idx = region_idx_of(adj_idx + offsets[next_dir]);
+                if (near_region_idx != -1) {
+                    enqueue_region(near_region_idx);
+                }
+            }
+        }
+    }
+}
+
+template <class Layout>
+bool Solver<Layout>::can_reach_target(int region_idx) {
+    Region &region = regions[region_idx];
+    int needed = region.get_target_size() - region.get_size();
+    if (needed <= 0) return true;
+
+    const int *offsets = layout.get_adj_offsets();
+    int reachable = 0;
+
+    // BFS from the members, the queue starts with them
+    new_mark_pass();
+    flood_queue.clear();
+    for (int i = 0; i < region.get_size(); i++) {
+        cell_marks[region.cell_at(i)] = mark_stamp;
+        flood_queue.push_back(region.cell_at(i));
+    }
+
+    for (long unsigned int i = 0; i < flood_queue.size(); i++) {
+        for (int dir = 0; dir < 4; dir++) {
+            CellIdx idx = flood_queue[i] + offsets[dir];
+            if (cell_marks[idx] == mark_stamp) continue;
+            cell_marks[idx] = mark_stamp;
+
+            if (board.at(idx).region_id == -1) {
+                // region only grows, so the cell that would overflow it now is never usable
+                if (size_after_adding(region_idx, idx) > region.get_target_size()) continue;
+
+                reachable++;
+                flood_queue.push_back(idx);
+            } else {
+                // unfinished region of the same value is merged with all its cells
+                int other_idx = region_idx_of(idx);
+                if (other_idx == -1 || other_idx == region_idx || is_completed(other_idx)) continue;
+
+                Region &other = regions[other_idx];
+                if (other.get_target_size() != region.get_target_size()) continue;
+
+                reachable += other.get_size();
+                for (int j = 0; j < other.get_size(); j++) {
+                    cell_marks[other.cell_at(j)] = mark_stamp;
+                    flood_queue.push_back(other.cell_at(j));
+                }
+            }
+
+            if (reachable >= needed) return true;
+        }
+    }
+
+    return false;
+}
+
+template <class Layout>
+void Solver<Layout>::clear_propagation_queue() {
+    for (long unsigned int i = 0; i < propagation_queue.size(); i++) {
+        is_queued[propagation_queue[i]] = 0;
+    }
+
+    propagation_queue.clear();
+}
+
+template <class Layout>
+bool Solver<Layout>::propagate() {
+    while (!propagation_queue.empty()) {
+        int region_idx = propagation_queue.back();
+        propagation_queue.pop_back();
+        is_queued[region_idx] = 0;
+
+        if (merged_into[region_idx] != -1 || is_completed(region_idx)) {
+            set_region_key(region_idx, REGION_KEY_MAX);
+            continue;
+        }
+
+        // failures of the children depend on the regions checked after them (see SearchLevel)
+        if (config.uses_backjumping && level_count > 0) {
+            levels[level_count - 1].checked_regions.push_back(region_idx);
+        }
+
+        if (!can_reach_target(region_idx)) {
+            clear_propagation_queue();
+            return false;
+        }
+
+        CellIdx exit;
+        int exit_count = count_exits(region_idx, exit);
+        if (exit_count > 1) {
+            // fail first: the smallest slack between the exits and the cells region still needs,
+            // then the smallest number of needed cells. Slack can be negative, it's shifted by MAX_CELL_VAL
+            Region &region = regions[region_idx];
+            int needed = region.get_target_size() - region.get_size();
+            set_region_key(region_idx, (exit_count - needed + MAX_CELL_VAL) * (MAX_CELL_VAL + 1) + needed);
+            continue;
+        }
+
+        if (exit_count == 0 || !add_cell(region_idx, exit)) {
+            clear_propagation_queue();
+            return false;
+        }
+
+        // full fill: areas closed by the forced region are found at once, as after the search completes one
+        if (board.fills_all_cells && is_completed(region_idx) && !check_areas_near(region_idx)) {
+            clear_propagation_queue();
+            return false;
+        }
+
+        // region has grown: it may have only one exit again, its neighbours lost the exit
+        enqueue_regions_near(region_idx);
+    }
+
+    return true;
+}
+
+template <class Layout>
+bool Solver<Layout>::check_area(CellIdx start, int limit) {
+    const int *offsets = layout.get_adj_offsets();
+
+    // BFS over the area, unfinished regions around it are collected once
+    new_mark_pass();
+    flood_queue.clear();
+    area_regions.clear();
+    cell_marks[start] = mark_stamp;
+    flood_queue.push_back(start);
+    for (long unsigned int i = 0; i < flood_queue.size(); i++) {
+        if (static_cast<int>(flood_queue.size()) > limit) return true;
+
+        for (int dir = 0; dir < 4; dir++) {
+            CellIdx idx = flood_queue[i] + offsets[dir];
+            if (cell_marks[idx] == mark_stamp) continue;
+
+            if (board.at(idx).region_id == -1) {
+                cell_marks[idx] = mark_stamp;
+                flood_queue.push_back(idx);
+                continue;
+            }
+
+            int region_idx = region_idx_of(idx);
+            if (region_idx == -1 || region_marks[region_idx] == mark_stamp || is_completed(region_idx)) continue;
+
+            region_marks[region_idx] = mark_stamp;
+            area_regions.push_back(region_idx);
+        }
+    }
+
+    // full fill: closed area of one or two cells is one region of its size, two regions of 1 would touch
+    int area_size = static_cast<int>(flood_queue.size());
+    if (board.fills_all_cells && area_regions.empty()) {
+        for (int i = 0; i < area_size && area_size <= 2; i++) {
+            if (touches_value(flood_queue[i], area_size)) return false;
+        }
+
+        if (closed_area_cell == -1 || area_size < closed_area_size) {
+            closed_area_cell = start;
+            closed_area_size = area_size;
+        }
+    }
+
+    // Regions of the same value that can grow only into this area are counted together,
+    // because they may be merged. k merged groups with total size s take k * value - s cells,
+    // k can't be less than s / value. If any region of the value touches other area, the value is skipped
+    int value_sizes[MAX_CELL_VAL + 1];
+    bool is_value_closed[MAX_CELL_VAL + 1];
+    for (long unsigned int i = 0; i < area_regions.size(); i++) {
+        int value = regions[area_regions[i]].get_target_size();
+        value_sizes[value] = 0;
+        is_value_closed[value] = true;
+    }
+
+    for (long unsigned int i = 0; i < area_regions.size(); i++) {
+        Region &region = regions[area_regions[i]];
+        int value = region.get_target_size();
+        value_sizes[value] += region.get_size();
+
+        for (int j = 0; j < region.get_size() && is_value_closed[value]; j++) {
+            for (int dir = 0; dir < 4; dir++) {
+                CellIdx idx = region.cell_at(j) + offsets[dir];
+                if (board.at(idx).region_id == -1 && cell_marks[idx] != mark_stamp) {
+                    is_value_closed[value] = false;
+                }
+            }
+        }
+    }
+
+    int demand = 0;
+    for (long unsigned int i = 0; i < area_regions.size(); i++) {
+        int value = regions[area_regions[i]].get_target_size();
+        if (!is_value_closed[value]) continue;
+
+        int group_count = (value_sizes[value] + value - 1) / value;
+        demand += group_count * value - value_sizes[value];
+        is_value_closed[value] = false; // counted
+    }
+
+    return demand <= static_cast<int>(flood_queue.size());
+}
+
+template <class Layout>
+bool Solver<Layout>::check_areas_near(int region_idx) {
+    if (config.area_check_limit == 0) return true;
+
+    Region &region = regions[region_idx];
+    const int *offsets = layout.get_adj_offsets();
+
+    // the same area can be adjacent to several members, it's checked again only if it was too big.
+    // Every check is a pass
+    reserve_mark_passes(static_cast<unsigned int>(region.get_size()) * 4);
+    unsigned int first_stamp = mark_stamp + 1;
+    for (int i = 0; i < region.get_size(); i++) {
+        for (int dir = 0; dir < 4; dir++) {
+            CellIdx idx = region.cell_at(i) + offsets[dir];
+            if (board.at(idx).region_id != -1) continue;
+            if (cell_marks[idx] >= first_stamp && cell_marks[idx] <= mark_stamp) continue;
+
+            if (!check_area(idx, config.area_check_limit)) return false;
+        }
+    }
+
+    return true;
+}
+
+template <class Layout>
+bool Solver<Layout>::check_all_areas() {
+    // areas aren't limited, so every area is checked once. Every check is a pass
+    reserve_mark_passes(static_cast<unsigned int>(layout.get_grid_size()));
+    unsigned int first_stamp = mark_stamp + 1;
+    for (int row = 0; row < board.get_rows(); row++) {
+        for (int col = 0; col < board.get_cols(); col++) {
+            CellIdx idx = board.idx_of(row, col);
+            if (board.at(idx).region_id != -1) continue;
+            if (cell_marks[idx] >= first_stamp && cell_marks[idx] <= mark_stamp) continue;
+
+            if (!check_area(idx, layout.get_grid_size())) return false;
+        }
+    }
+
+    return true;
+}
+
+// members defined here are instantiated here, the rest of the class in solver.cpp
+#define INSTANTIATE_PROPAGATION(LAYOUT) \
+    template int Solver<LAYOUT>::count_exits(int region_idx, CellIdx &exit); \
+    template void Solver<LAYOUT>::enqueue_region(int region_idx); \
+    template void Solver<LAYOUT>::enqueue_regions_near(int region_idx); \
+    template bool Solver<LAYOUT>::can_reach_target(int region_idx); \
+    template void Solver<LAYOUT>::clear_propagation_queue(); \
+    template bool Solver<LAYOUT>::propagate(); \
+    template bool Solver<LAYOUT>::check_area(CellIdx start, int limit); \
+    template bool Solver<LAYOUT>::check_areas_near(int region_idx); \
+    template bool Solver<LAYOUT>::check_all_areas();
+
+INSTANTIATE_PROPAGATION(DynamicLayout)
+INSTANTIATE_PROPAGATION(Layout8x8)
+INSTANTIATE_PROPAGATION(Layout10x10)
+INSTANTIATE_PROPAGATION(Layout12x12)
+INSTANTIATE_PROPAGATION(Layout16x16)
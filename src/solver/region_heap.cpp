@@ -0,0 +1,94 @@
+#include "solver/region_heap.h"
+#include <algorithm>
+#include <random>
+
+// =-=-=-=-=-=-=-= Private methods =-=-=-=-=-=-=-=
+bool RegionHeap::is_less(int pos_a, int pos_b) {
+    int key_a = keys[heap[pos_a]];
+    int key_b = keys[heap[pos_b]];
+    return key_a < key_b || (key_a == key_b && ranks[heap[pos_a]] < ranks[heap[pos_b]]);
+}
+
+void RegionHeap::swap_at(int pos_a, int pos_b) {
+    int region_a = heap[pos_a];
+    heap[pos_a] = heap[pos_b];
+    heap[pos_b] = region_a;
+
+    positions[heap[pos_a]] = pos_a;
+    positions[heap[pos_b]] = pos_b;
+}
+
+void RegionHeap::sift_up(int pos) {
+    while (pos > 0) {
+        int parent = (pos - 1) / 2;
+        if (!is_less(pos, parent)) return;
+
+        swap_at(pos, parent);
+        pos = parent;
+    }
+}
+
+void RegionHeap::sift_down(int pos) {
+    int size = static_cast<int>(heap.size());
+    while (true) {
+        int smallest = pos;
+        int left = 2 * pos + 1;
+        int right = left + 1;
+        if (left < size && is_less(left, smallest)) smallest = left;
+        if (right < size && is_less(right, smallest)) smallest = right;
+        if (smallest == pos) return;
+
+        swap_at(pos, smallest);
+        pos = smallest;
+    }
+}
+
+// =-=-=-=-=-=-=-= Public methods =-=-=-=-=-=-=-=
+void RegionHeap::reset(int region_count, unsigned int tie_seed) {
+    ranks.resize(region_count);
+    for (int i = 0; i < region_count; i++) {
+        ranks[i] = i;
+    }
+
+    if (tie_seed != 0) {
+        std::mt19937 generator(tie_seed);
+        std::shuffle(ranks.begin(), ranks.end(), generator);
+    }
+
+    // equal keys are ordered by rank, so the array sorted by rank is already a heap
+    heap.resize(region_count);
+    positions.resize(region_count);
+    keys.assign(region_count, 0);
+    for (int i = 0; i < region_count; i++) {
+        heap[ranks[i]] = i;
+        positions[i] = ranks[i];
+    }
+}
+
+int RegionHeap::get_top() {
+    return heap.empty() ? -1 : heap[0];
+}
+
+int RegionHeap::get_key(int region_idx) {
+    return keys[region_idx];
+}
+
+void RegionHeap::push(int key) {
+    int region_idx = static_cast<int>(heap.size());
+    ranks.push_back(region_idx);
+    positions.push_back(region_idx);
+    keys.push_back(key);
+    heap.push_back(region_idx);
+    sift_up(region_idx);
+}
+
+void RegionHeap::set_key(int region_idx, int key) {
+    int old_key = keys[region_idx];
+    keys[region_idx] = key;
+
+    if (key < old_key) {
+        sift_up(positions[region_idx]);
+    } else {
+        sift_down(positions[region_idx]);
+    }
+}
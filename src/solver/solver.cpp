@@ -1,113 +1,1582 @@
 #include "solver/solver.h"
+#include "solver/exact_cover.h"
+#include "solver/manual_solving.h"
 #include "solver/utils.h"
+#include <algorithm>
+#include <atomic>
+#include <climits>
+#include <functional>
+#include <thread>
 #include <vector>
 
-bool solve(Board &board) {
-    int idx = get_next_unfilled_fixed_cell_idx(board);
-    if (idx == -1) {
-        fill_empty_board(board);
-        return true; 
+template <class Layout>
+Solver<Layout>::Solver(Board &board) : Solver(board, own_context) {}
+
+template <class Layout>
+Solver<Layout>::Solver(Board &board, SolverContext &context)
+    : board(board), layout(board), regions(context.regions), merged_into(context.merged_into),
+    frames(context.frames), untried(context.untried), seen_ids(context.seen_ids),
+    seen_trail(context.seen_trail), trail(context.trail), propagation_queue(context.propagation_queue),
+    is_queued(context.is_queued), region_heap(context.region_heap), cell_marks(context.cell_marks),
+    flood_queue(context.flood_queue), region_marks(context.region_marks), area_regions(context.area_regions),
+    component_cells(context.component_cells), component_bounds(context.component_bounds),
+    p_failed_states(nullptr), cell_levels(context.cell_levels), levels(context.levels),
+    scope_levels(context.scope_levels), conflict_scratch(context.conflict_scratch),
+    learned_nogoods(context.learned_nogoods), level_count(0), state_key(0), step_count(0),
+    region_id_base(0), mark_stamp(0), config(DEFAULT_SEARCH_CONFIG), root_region_idx(-1),
+    root_blank_cell(-1), closed_area_cell(-1), closed_area_size(0), p_parallel(nullptr), thread_idx(0),
+    task_depth(0), poll_countdown(SEARCH_POLL_INTERVAL), solution_cells(context.solution_cells),
+    solution_limit(1), solution_count(0), has_first_solution(false) {}
+
+// =-=-=-=-=-=-=-= Private methods =-=-=-=-=-=-=-=
+template <class Layout>
+int Solver<Layout>::region_idx_of(CellIdx idx) {
+    // free (-1), single (-2) and sentinel (-3) cells have negative ids
+    int region_id = board.at(idx).region_id;
+    return region_id >= region_id_base ? region_id - region_id_base : -1;
+}
+
+template <class Layout>
+bool Solver<Layout>::is_completed(int region_idx) {
+    Region &region = regions[region_idx];
+    return region.get_size() == region.get_target_size();
+}
+
+template <class Layout>
+bool Solver<Layout>::create_regions() {
+    const int *offsets = layout.get_adj_offsets();
+
+    for (long unsigned int i = 0; i < board.fixed_cells.size(); i++) {
+        CellIdx start = board.fixed_cells[i];
+        if (board.at(start).region_id != -1) continue; // already in the group
+
+        Region region = board.create_region(board.at(start).get_value());
+        if (regions.empty()) {
+            region_id_base = region.get_id();
+        }
+
+        // flood fill over the clues with the same value, region cells are used as a queue
+        region.push(start);
+        board.at(start).region_id = region.get_id();
+        for (int j = 0; j < region.get_size(); j++) {
+            CellIdx idx = region.cell_at(j);
+            for (int dir = 0; dir < 4; dir++) {
+                Cell &adj_cell = board.at(idx + offsets[dir]);
+                if (adj_cell.region_id != -1 || adj_cell.get_value() != region.get_target_size()) continue;
+
+                adj_cell.region_id = region.get_id();
+                region.push(idx + offsets[dir]);
+            }
+        }
+
+        if (region.get_size() > region.get_target_size()) return false;
+
+        regions.push_back(region);
+        merged_into.push_back(-1);
     }
 
-    Coord fixed_cell_coord = board.fixed_cell_coords.at(idx);
-    Cell &fixed_cell = board.cell_at(fixed_cell_coord);
-    Region region = board.create_region(fixed_cell.get_value());
+    is_queued.assign(regions.size(), 0);
+    return true;
+}
 
-    fixed_cell.region_id = region.get_id();
-    region.push(fixed_cell_coord);
+template <class Layout>
+void Solver<Layout>::new_mark_pass() {
+    mark_stamp++;
+    if (mark_stamp == 0) { // overflow, old marks could match again
+        reset_marks();
+        mark_stamp = 1;
+    }
+}
 
-    bool result = solve(board, &region, fixed_cell);
-    if (result) {
-        // Results arrive in the end-to-start order. We need to reverse them
-        reverse_vector(board.result);
+template <class Layout>
+void Solver<Layout>::reserve_mark_passes(unsigned int count) {
+    if (mark_stamp > UINT_MAX - count) {
+        reset_marks();
     }
+}
 
-    return result;
+template <class Layout>
+void Solver<Layout>::reset_marks() {
+    // regions share the stamp with the cells
+    cell_marks.assign(cell_marks.size(), 0);
+    region_marks.assign(region_marks.size(), 0);
+    mark_stamp = 0;
 }
 
-bool solve(Board &board, Region *p_region, Cell &cell) {
-    std::vector<Coord> adjs_with_same_val;
-    get_adjs_with_same_val(board, cell, adjs_with_same_val);
-    int adj_coords_num = static_cast<int>(adjs_with_same_val.size());
-    
-    // these cells don't fit into the region, but can't stay adjacent to it, go back
-    if (p_region->get_size() + adj_coords_num > p_region->get_target_size()) {
-        return false;
+template <class Layout>
+int Solver<Layout>::size_after_adding(int region_idx, CellIdx idx) {
+    Region &region = regions[region_idx];
+    const int *offsets = layout.get_adj_offsets();
+    int size = region.get_size() + 1;
+
+    int touched[4]; // every region is counted once
+    int touched_count = 0;
+    for (int dir = 0; dir < 4; dir++) {
+        int adj_region_idx = region_idx_of(idx + offsets[dir]);
+        if (adj_region_idx == -1 || adj_region_idx == region_idx) continue;
+
+        Region &adj_region = regions[adj_region_idx];
+        if (adj_region.get_target_size() != region.get_target_size()) continue;
+
+        bool is_counted = false;
+        for (int i = 0; i < touched_count; i++) {
+            is_counted |= touched[i] == adj_region_idx;
+        }
+
+        if (!is_counted) {
+            touched[touched_count++] = adj_region_idx;
+            size += adj_region.get_size();
+        }
     }
 
-    // add every cell to region if there is any
-    for (int i = 0; i < adj_coords_num; i++) {
-        Coord adj_coord = adjs_with_same_val.at(i);
-        Cell &adj_cell = board.cell_at(adj_coord);
-        
-        // adJ_cell.region_id has to be only -1 
-        adj_cell.region_id = p_region->get_id();
-        p_region->push(adj_coord);
+    return size;
+}
+
+template <class Layout>
+bool Solver<Layout>::add_cell(int region_idx, CellIdx idx) {
+    Region &region = regions[region_idx];
+    Cell &cell = board.at(idx);
+    cell.region_id = region.get_id();
+    cell.set_value(region.get_target_size());
+    region.push(idx);
+    cell_levels[idx] = level_count - 1;
+    trail.push_back({ TrailKind::Cell, region_idx, -1 });
+    state_key ^= zobrist_key(idx, region.get_target_size());
+
+    const int *offsets = layout.get_adj_offsets();
+    for (int dir = 0; dir < 4; dir++) {
+        int adj_region_idx = region_idx_of(idx + offsets[dir]);
+        if (adj_region_idx == -1 || adj_region_idx == region_idx) continue;
+
+        if (regions[adj_region_idx].get_target_size() == region.get_target_size()) {
+            merge_region(region_idx, adj_region_idx);
+        }
+    }
+
+    return region.get_size() <= region.get_target_size();
+}
+
+template <class Layout>
+void Solver<Layout>::merge_region(int region_idx, int merged_idx) {
+    // cells are copied, the list of the merged region stays untouched for the undo
+    Region &region = regions[region_idx];
+    Region &merged = regions[merged_idx];
+    for (int i = 0; i < merged.get_size(); i++) {
+        CellIdx idx = merged.cell_at(i);
+        board.at(idx).region_id = region.get_id();
+        region.push(idx);
     }
 
-    // region completed
-    if (p_region->get_size() == p_region->get_target_size()) {
-        int idx = get_next_unfilled_fixed_cell_idx(board);
-        if (idx == -1) {
-            board.result.push_back(cell.get_coord());
-            concat_vectors(board.result, adjs_with_same_val);
+    merged_into[merged_idx] = region_idx;
+    trail.push_back({ TrailKind::Merge, region_idx, merged_idx });
+    set_region_key(merged_idx, REGION_KEY_MAX);
+}
+
+template <class Layout>
+void Solver<Layout>::set_region_key(int region_idx, int key) {
+    int old_key = region_heap.get_key(region_idx);
+    if (key == old_key) return;
+
+    region_heap.set_key(region_idx, key);
+    trail.push_back({ TrailKind::Key, region_idx, old_key });
+}
+
+template <class Layout>
+void Solver<Layout>::undo_to(int trail_mark) {
+    while (static_cast<int>(trail.size()) > trail_mark) {
+        TrailEntry entry = trail.back();
+        trail.pop_back();
+
+        switch (entry.kind) {
+            case TrailKind::Cell: {
+                Region &region = regions[entry.region_idx];
+                state_key ^= zobrist_key(region.cell_at(region.get_size() - 1), region.get_target_size());
+                undo_last_cell(board, &region);
+                break;
+            }
+
+            case TrailKind::Merge: {
+                // cells of the merged region are the last ones in the region
+                Region &region = regions[entry.region_idx];
+                Region &merged = regions[entry.value];
+                for (int i = 0; i < merged.get_size(); i++) {
+                    board.at(region.pop()).region_id = merged.get_id();
+                }
+
+                merged_into[entry.value] = -1;
+                break;
+            }
+
+            case TrailKind::Key:
+                region_heap.set_key(entry.region_idx, entry.value);
+                break;
+
+            case TrailKind::Target:
+                regions[entry.region_idx].reset(entry.value);
+                break;
+
+            case TrailKind::BlankScan:
+                blank_scan_idx = entry.value;
+                break;
+        }
+    }
+}
+
+template <class Layout>
+bool Solver<Layout>::next_candidate(SearchFrame &frame, CellIdx &idx) {
+    Region &region = regions[frame.region_idx];
+
+    // skipped cells stay tried: the cell that is owned or overflows the region can't be added deeper either
+    while (frame.untried_pos < frame.child_end) {
+        idx = untried[frame.untried_pos];
+        frame.untried_pos++;
+
+        if (
+            board.at(idx).region_id == -1 &&
+            size_after_adding(frame.region_idx, idx) <= region.get_target_size()
+        ) {
             return true;
         }
-     
-        Coord next_cell_coord = board.fixed_cell_coords.at(idx);
-        Cell &next_cell = board.cell_at(next_cell_coord);
-        Region region = board.create_region(next_cell.get_value());
-        
-        next_cell.region_id = region.get_id();
-        region.push(next_cell_coord);
-        
-        if (!solve(board, &region, next_cell)) {
-            // undo for next_cell
-            next_cell.region_id = -1;
-
-            // undo every adjacent cell that we filled at the start
-            for (int i = 0; i < adj_coords_num; i++) {
-                Coord adj_coord = adjs_with_same_val.at(i);
-                Cell &adj_cell = board.cell_at(adj_coord);
-                undo_cell(board, p_region, adj_cell);
-            }
-
-            return false;
-        } 
-        
-        board.result.push_back(cell.get_coord());
-        concat_vectors(board.result, adjs_with_same_val);
-        return true;
-    }
-
-
-    if (solve_for_each_adjacent(board, p_region, cell)) {
-        board.result.push_back(cell.get_coord());
-        concat_vectors(board.result, adjs_with_same_val);
-        return true;
-    }
-
-    // try for every cell in current region
-    for (int i = 0; i < p_region->get_size(); i++) {
-        Coord coord = p_region->coord_at(i);
-        if (coord == cell.get_coord()) continue;
-
-        Cell &cell_in_reg = board.cell_at(coord);
-        if (!has_any_free_adj_cell(board, cell_in_reg)) continue;
- 
-        if (solve_for_each_adjacent(board, p_region, cell_in_reg)) {
-            board.result.push_back(cell.get_coord());
-            concat_vectors(board.result, adjs_with_same_val);
+    }
+
+    return false;
+}
+
+template <class Layout>
+int Solver<Layout>::next_open_region() {
+    while (true) {
+        int region_idx = region_heap.get_top();
+        if (region_idx == -1 || region_heap.get_key(region_idx) == REGION_KEY_MAX) return -1;
+        if (!is_completed(region_idx)) return region_idx;
+
+        // completed after its key was set (it isn't checked by the propagation)
+        set_region_key(region_idx, REGION_KEY_MAX);
+    }
+}
+
+template <class Layout>
+CellIdx Solver<Layout>::next_blank_cell(bool has_open_regions) {
+    if (!board.fills_all_cells) return -1;
+    if (closed_area_cell != -1 && board.at(closed_area_cell).region_id == -1) return closed_area_cell;
+    if (has_open_regions) return -1;
+
+    // areas that weren't checked are left to the end. Sentinels at the row ends are never free
+    CellIdx last_idx = board.idx_of(board.get_rows() - 1, board.get_cols() - 1);
+    CellIdx idx = blank_scan_idx;
+    while (idx <= last_idx && board.at(idx).region_id != -1) {
+        idx++;
+    }
+
+    if (idx != blank_scan_idx) {
+        trail.push_back({ TrailKind::BlankScan, -1, blank_scan_idx });
+        blank_scan_idx = idx;
+    }
+
+    return idx <= last_idx ? idx : -1;
+}
+
+template <class Layout>
+void Solver<Layout>::push_frame(int region_idx, int seen_id) {
+    SearchFrame frame;
+    frame.region_idx = region_idx;
+    frame.seen_id = seen_id;
+    frame.untried_begin = frame.untried_pos = frame.untried_end = static_cast<int>(untried.size());
+    frame.trail_mark = static_cast<int>(trail.size());
+    frame.seen_mark = static_cast<int>(seen_trail.size());
+    frame.shape_pos = frame.shape_end = 0;
+    frame.child_end = frame.untried_end;
+    frame.is_split = false;
+    frame.step_mark = step_count;
+    frame.blank_cell = -1;
+    frames.push_back(frame);
+}
+
+template <class Layout>
+void Solver<Layout>::add_untried_adjs(SearchFrame &frame, int first_member) {
+    Region &region = regions[frame.region_idx];
+    const int *offsets = layout.get_adj_offsets();
+
+    for (int i = first_member; i < region.get_size(); i++) {
+        for (int j = 0; j < 4; j++) {
+            CellIdx idx = region.cell_at(i) + offsets[config.directions[j]];
+            if (board.at(idx).region_id != -1 || seen_ids[idx] == frame.seen_id) continue;
+
+            seen_trail.push_back({ idx, seen_ids[idx] });
+            seen_ids[idx] = frame.seen_id;
+            untried.push_back(idx);
+        }
+    }
+
+    frame.untried_end = frame.child_end = static_cast<int>(untried.size());
+}
+
+template <class Layout>
+void Solver<Layout>::push_level() {
+    if (level_count == static_cast<int>(levels.size())) {
+        levels.emplace_back();
+    }
+
+    SearchLevel &level = levels[level_count++];
+    level.frame_idx = static_cast<int>(frames.size()) - 1;
+    level.conflict_floor = 0;
+    level.conflict.clear();
+    level.checked_regions.clear();
+    level.is_leaf = true;
+    level.is_split = false;
+}
+
+template <class Layout>
+void Solver<Layout>::push_region_frame(int region_idx, CellIdx blank_cell, int blank_size) {
+    // frames below are never popped while this one is on the stack, so the id is unique
+    push_frame(region_idx, static_cast<int>(frames.size()) + 1);
+    push_level();
+
+    if (blank_cell != -1) {
+        set_region_target(region_idx, blank_size);
+        add_cell(region_idx, blank_cell);
+    }
+
+    int value = regions[region_idx].get_target_size();
+    if (value <= POLYOMINO_MAX_SIZE) {
+        int shape_count = POLYOMINOES.first_of_size[value + 1] - POLYOMINOES.first_of_size[value];
+        frames.back().shape_end = frames.back().child_end = shape_count * value;
+        return;
+    }
+
+    add_untried_adjs(frames.back(), 0);
+}
+
+template <class Layout>
+void Solver<Layout>::push_root_frame() {
+    if (root_blank_cell != -1) {
+        push_blank_frame(root_blank_cell);
+    } else {
+        push_region_frame(root_region_idx);
+    }
+}
+
+template <class Layout>
+void Solver<Layout>::push_blank_frame(CellIdx idx) {
+    // slot of the region is added when the branch has more blank regions than any branch before
+    int region_idx = first_blank_idx + blank_depth;
+    if (region_idx == static_cast<int>(regions.size())) {
+        regions.push_back(board.create_region(0));
+        if (region_idx == 0) {
+            region_id_base = regions[0].get_id();
+        }
+
+        merged_into.push_back(-1);
+        is_queued.push_back(false);
+        region_marks.push_back(0);
+        region_heap.push(REGION_KEY_MAX);
+    }
+
+    // the region can't be bigger than the free area around the cell
+    int area_size = 1;
+    new_mark_pass();
+    flood_queue.clear();
+    flood_queue.push_back(idx);
+    cell_marks[idx] = mark_stamp;
+    const int *offsets = layout.get_adj_offsets();
+    for (long unsigned int i = 0; i < flood_queue.size() && area_size < MAX_CELL_VAL; i++) {
+        for (int dir = 0; dir < 4 && area_size < MAX_CELL_VAL; dir++) {
+            CellIdx adj_idx = flood_queue[i] + offsets[dir];
+            if (cell_marks[adj_idx] == mark_stamp || board.at(adj_idx).region_id != -1) continue;
+
+            cell_marks[adj_idx] = mark_stamp;
+            flood_queue.push_back(adj_idx);
+            area_size++;
+        }
+    }
+
+    // the node has the id of its index as the region nodes, it never marks cells with it
+    push_frame(region_idx, static_cast<int>(frames.size()) + 1);
+    push_level();
+    levels[level_count - 1].is_leaf = false; // its children are the next regions
+    SearchFrame &frame = frames.back();
+    frame.blank_cell = idx;
+    frame.untried_pos = 1;
+    frame.child_end = area_size + 1;
+    blank_depth++;
+}
+
+template <class Layout>
+bool Solver<Layout>::next_blank_size(SearchFrame &frame, int &size) {
+    while (frame.untried_pos < frame.child_end) {
+        size = frame.untried_pos;
+        frame.untried_pos++;
+
+        if (!touches_value(frame.blank_cell, size)) return true;
+    }
+
+    return false;
+}
+
+template <class Layout>
+bool Solver<Layout>::touches_value(CellIdx idx, int value) {
+    const int *offsets = layout.get_adj_offsets();
+    for (int dir = 0; dir < 4; dir++) {
+        if (board.at(idx + offsets[dir]).get_value() == value) return true;
+    }
+
+    return false;
+}
+
+template <class Layout>
+void Solver<Layout>::set_region_target(int region_idx, int target_size) {
+    Region &region = regions[region_idx];
+    trail.push_back({ TrailKind::Target, region_idx, region.get_target_size() });
+    region.reset(target_size);
+}
+
+template <class Layout>
+bool Solver<Layout>::push_child_frame(CellIdx idx) {
+    SearchFrame parent = frames.back(); // copy, push may move the frames
+    push_frame(parent.region_idx, parent.seen_id);
+
+    for (int i = parent.untried_pos; i < parent.untried_end; i++) {
+        CellIdx untried_idx = untried[i];
+        untried.push_back(untried_idx);
+    }
+
+    // the cell and all merged cells are new members
+    int first_member = regions[parent.region_idx].get_size();
+    if (!add_cell(parent.region_idx, idx)) return false;
+
+    add_untried_adjs(frames.back(), first_member);
+    return true;
+}
+
+template <class Layout>
+bool Solver<Layout>::is_legal_placement(int region_idx, const Polyomino &shape, CellIdx origin) {
+    int value = regions[region_idx].get_target_size();
+    int stride = layout.get_adj_offsets()[2];
+
+    // every owned cell is counted once and every owner once, so the counts match only for whole regions
+    int owned_count = 0;
+    int owner_sizes = 0;
+    new_mark_pass();
+    for (int i = 0; i < shape.size; i++) {
+        CellIdx idx = origin + shape.cells[i].row * stride + shape.cells[i].col;
+        if (board.at(idx).region_id == -1) continue;
+
+        int owner_idx = region_idx_of(idx);
+        if (owner_idx == -1 || regions[owner_idx].get_target_size() != value) return false;
+
+        owned_count++;
+        if (region_marks[owner_idx] != mark_stamp) {
+            region_marks[owner_idx] = mark_stamp;
+            owner_sizes += regions[owner_idx].get_size();
+        }
+    }
+
+    if (owned_count != owner_sizes) return false;
+
+    for (int i = 0; i < shape.border_size; i++) {
+        int owner_idx = region_idx_of(origin + shape.border[i].row * stride + shape.border[i].col);
+        if (owner_idx != -1 && regions[owner_idx].get_target_size() == value) return false;
+    }
+
+    return true;
+}
+
+template <class Layout>
+void Solver<Layout>::fill_placement_window(int region_idx, CellIdx center, std::uint64_t *window) {
+    int value = regions[region_idx].get_target_size();
+    Coord coord = board.coord_of(center);
+
+    // cells farther than value - 1 from the center are never covered, they stay unusable
+    for (int i = 0; i < POLYOMINO_WINDOW_WORDS; i++) {
+        window[i] = 0;
+    }
+
+    for (int row = coord.row - value + 1; row <= coord.row + value - 1; row++) {
+        if (row < 0 || row >= board.get_rows()) continue;
+
+        for (int col = coord.col - value + 1; col <= coord.col + value - 1; col++) {
+            if (col < 0 || col >= board.get_cols()) continue;
+
+            CellIdx idx = board.idx_of(row, col);
+            if (board.at(idx).region_id != -1) {
+                int owner_idx = region_idx_of(idx);
+                if (owner_idx == -1 || regions[owner_idx].get_target_size() != value) continue;
+            }
+
+            int bit = polyomino_window_bit(row - coord.row, col - coord.col);
+            window[bit / 64] |= std::uint64_t(1) << (bit % 64);
+        }
+    }
+}
+
+template <class Layout>
+bool Solver<Layout>::next_placement(SearchFrame &frame, const Polyomino *&p_shape, CellIdx &origin) {
+    Region &region = regions[frame.region_idx];
+    int value = region.get_target_size();
+    int stride = layout.get_adj_offsets()[2];
+    CellIdx center = region.cell_at(0);
+
+    // the window is the same for all children, they are undone before the next one
+    std::uint64_t window[POLYOMINO_WINDOW_WORDS];
+    fill_placement_window(frame.region_idx, center, window);
+
+    while (frame.shape_pos < frame.child_end) {
+        const Polyomino &shape = POLYOMINOES.shapes[POLYOMINOES.first_of_size[value] + frame.shape_pos / value];
+        PolyominoCell center_cell = shape.cells[frame.shape_pos % value];
+        frame.shape_pos++;
+
+        if (!polyomino_fits(shape, center_cell, window)) continue;
+
+        origin = center - (center_cell.row * stride + center_cell.col);
+        if (is_legal_placement(frame.region_idx, shape, origin)) {
+            p_shape = &shape;
             return true;
         }
     }
 
-    // undo every adjacent cell that we filled at the start
-    for (int i = 0; i < adj_coords_num; i++) {
-        Coord adj_coord = adjs_with_same_val.at(i);
-        Cell &adj_cell = board.cell_at(adj_coord);
-        undo_cell(board, p_region, adj_cell);
+    return false;
+}
+
+template <class Layout>
+void Solver<Layout>::push_placement_frame(const Polyomino &shape, CellIdx origin) {
+    // the node has no untried cells, its only child is the next region
+    SearchFrame parent = frames.back();
+    push_frame(parent.region_idx, parent.seen_id);
+
+    // regions of the same value in the shape are merged by the free cells next to them
+    int stride = layout.get_adj_offsets()[2];
+    for (int i = 0; i < shape.size; i++) {
+        CellIdx idx = origin + shape.cells[i].row * stride + shape.cells[i].col;
+        if (board.at(idx).region_id == -1) {
+            add_cell(parent.region_idx, idx);
+        }
+    }
+}
+
+template <class Layout>
+void Solver<Layout>::pop_frame() {
+    SearchFrame &frame = frames.back();
+    undo_to(frame.trail_mark);
+
+    while (static_cast<int>(seen_trail.size()) > frame.seen_mark) {
+        SeenEntry entry = seen_trail.back();
+        seen_trail.pop_back();
+        seen_ids[entry.idx] = entry.seen_id;
+    }
+
+    untried.resize(frame.untried_begin);
+    if (frame.seen_id == static_cast<int>(frames.size())) {
+        level_count--;
+    }
+    if (frame.blank_cell != -1) {
+        blank_depth--;
+    }
+
+    frames.pop_back();
+}
+
+template <class Layout>
+void Solver<Layout>::fill_result() {
+    // single cells are already in the result
+    for (long unsigned int i = 0; i < regions.size(); i++) {
+        if (merged_into[i] != -1) continue;
+
+        Region &region = regions[i];
+        for (int j = 0; j < region.get_size(); j++) {
+            board.result.push_back(board.coord_of(region.cell_at(j)));
+        }
+    }
+}
+
+template <class Layout>
+SearchStep Solver<Layout>::push_next_child() {
+    SearchFrame &frame = frames.back();
+    int region_idx = frame.region_idx;
+
+    if (frame.blank_cell != -1) {
+        int size;
+        if (!next_blank_size(frame, size)) return SearchStep::NoChildren;
+
+        CellIdx blank_cell = frame.blank_cell;
+        push_region_frame(region_idx, blank_cell, size);
+        if (config.uses_backjumping && is_known_nogood(region_idx)) {
+            frames.back().child_end = child_pos_of(frames.back());
+        }
+
+        return SearchStep::Pushed;
+    }
+
+    if (frame.shape_end != 0) {
+        const Polyomino *p_shape;
+        CellIdx origin;
+        if (!next_placement(frame, p_shape, origin)) return SearchStep::NoChildren;
+
+        push_placement_frame(*p_shape, origin);
+    } else {
+        CellIdx idx;
+        if (!next_candidate(frame, idx)) return SearchStep::NoChildren;
+        if (!push_child_frame(idx)) return SearchStep::DeadEnd;
+
+        if (!is_completed(region_idx)) {
+            // the region lost the cells it could use, so it may not reach the target anymore
+            return can_reach_target(region_idx) ? SearchStep::Pushed : SearchStep::DeadEnd;
+        }
+    }
+
+    // region completed: neighbours lost their exits, regions of the same value are blocked by it
+    closed_area_cell = -1;
+    enqueue_regions_near(region_idx);
+    if (!propagate() || !check_areas_near(region_idx)) return SearchStep::DeadEnd;
+
+    // node has only one child - the next region
+    frames.back().untried_pos = frames.back().child_end;
+    int next_region_idx = next_open_region();
+    CellIdx blank_cell = next_blank_cell(next_region_idx != -1);
+    if (next_region_idx == -1 && blank_cell == -1) return SearchStep::Solved;
+
+    levels[level_count - 1].is_leaf = false;
+    // the same board is reached by the portfolio threads in different orders
+    if (p_failed_states && p_failed_states->contains(state_key)) {
+        levels[level_count - 1].conflict_floor = level_count - 1; // proven by the whole board
+        return SearchStep::DeadEnd;
+    }
+
+    if (blank_cell != -1) {
+        push_blank_frame(blank_cell);
+        return SearchStep::Pushed;
+    }
+
+    push_region_frame(next_region_idx);
+    // node of the region in the scope of the learned nogood fails without children, so it backjumps as searched
+    if (config.uses_backjumping && is_known_nogood(next_region_idx)) {
+        frames.back().child_end = child_pos_of(frames.back());
+    }
+
+    return SearchStep::Pushed;
+}
+
+template <class Layout>
+bool Solver<Layout>::count_solution() {
+    solution_count++;
+    bool is_first = p_parallel ? p_parallel->add_solution() : solution_count == 1;
+    bool is_stopped = p_parallel ? p_parallel->get_is_stopped() : solution_count >= solution_limit;
+    if (is_first) {
+        fill_result();
+        has_first_solution = true;
+        if (!is_stopped) {
+            solution_cells.assign(&board.at(0), &board.at(0) + board.get_grid_size());
+        }
+    }
+
+    if (is_stopped) return true;
+
+    // every node on the stack has the solution below it, so their failures are neither stored nor learned
+    // and blame all previous levels: the search backtracks chronologically until it leaves them
+    for (long unsigned int i = 0; i < frames.size(); i++) {
+        frames[i].is_split = true;
+    }
+    for (int i = 0; i < level_count; i++) {
+        levels[i].is_split = true;
+    }
+
+    pop_frame();
+    return false;
+}
+
+template <class Layout>
+void Solver<Layout>::count_start_solution() {
+    // threads of the portfolio solve the same board, only one of them keeps it
+    solution_count = 1;
+    has_first_solution = !p_parallel || p_parallel->add_solution();
+}
+
+template <class Layout>
+bool Solver<Layout>::search(int base_depth) {
+    while (static_cast<int>(frames.size()) > base_depth) {
+        if (p_parallel && --poll_countdown == 0 && !poll()) return false;
+
+        step_count++;
+        switch (push_next_child()) {
+            case SearchStep::NoChildren: {
+                // region and blank nodes have the id of their index (see push_region_frame)
+                SearchFrame &frame = frames.back();
+                if (frame.seen_id != static_cast<int>(frames.size())) {
+                    pop_frame();
+                    break;
+                }
+
+                if (p_failed_states && !frame.is_split) {
+                    p_failed_states->insert(state_key, step_count - frame.step_mark);
+                }
+
+                if (config.uses_backjumping) {
+                    backjump(base_depth);
+                } else {
+                    pop_frame();
+                }
+                break;
+            }
+
+            case SearchStep::DeadEnd:
+                pop_frame();
+                break;
+
+            case SearchStep::Pushed:
+                break;
+
+            case SearchStep::Solved:
+                if (count_solution()) return true;
+                break;
+        }
     }
 
     return false;
 }
+
+template <class Layout>
+bool Solver<Layout>::split(SearchTask &task) {
+    // the shallowest node has the biggest subtrees
+    int depth = task_depth;
+    while (depth < static_cast<int>(frames.size())) {
+        SearchFrame &frame = frames[depth];
+        if (frame.child_end - child_pos_of(frame) >= 2) break;
+
+        depth++;
+    }
+
+    if (depth == static_cast<int>(frames.size())) return false;
+
+    // node above is the parent if the enumeration is the same or it's the size of the blank region,
+    // otherwise the node is its only child
+    task.path.clear();
+    for (int i = 0; i < depth; i++) {
+        if (frames[i + 1].seen_id == frames[i].seen_id || frames[i].blank_cell != -1) {
+            task.path.push_back(child_pos_of(frames[i]) - 1);
+        }
+    }
+
+    SearchFrame &frame = frames[depth];
+    task.child_begin = child_pos_of(frame) + (frame.child_end - child_pos_of(frame)) / 2;
+    task.child_end = frame.child_end;
+    frame.child_end = task.child_begin;
+    frame.is_split = true;
+
+    // the level of the node is the last one that starts at or below it
+    int level = level_count - 1;
+    while (levels[level].frame_idx > depth) {
+        level--;
+    }
+
+    levels[level].is_split = true;
+    return true;
+}
+
+template <class Layout>
+bool Solver<Layout>::poll() {
+    poll_countdown = SEARCH_POLL_INTERVAL;
+    if (p_parallel->get_is_stopped()) return false;
+
+    if (p_parallel->wants_task(thread_idx)) {
+        SearchTask task;
+        if (split(task)) {
+            p_parallel->push_task(thread_idx, std::move(task));
+        }
+    }
+
+    return true;
+}
+
+template <class Layout>
+void Solver<Layout>::add_scope_region(int region_idx, std::uint64_t &key) {
+    // propagation can add cells to the region at any level, undoing any of them changes the region.
+    // Cells are mostly in the order they were added, so runs of one level are listed once
+    Region &region = regions[region_idx];
+    bool is_inside = !is_completed(region_idx);
+    region_marks[region_idx] = mark_stamp;
+
+    int last_level = -1;
+    for (int i = 0; i < region.get_size(); i++) {
+        CellIdx idx = region.cell_at(i);
+        if (cell_levels[idx] != last_level) {
+            last_level = cell_levels[idx];
+            if (last_level != -1) {
+                scope_levels.push_back(last_level);
+            }
+        }
+        if (!is_inside) continue;
+
+        cell_marks[idx] = mark_stamp;
+        key ^= zobrist_key(idx, board.at(idx).get_value());
+        flood_queue.push_back(idx);
+    }
+}
+
+template <class Layout>
+bool Solver<Layout>::add_scope(int region_idx, std::uint64_t &key) {
+    if (region_marks[region_idx] == mark_stamp) return true;
+
+    long unsigned int first = flood_queue.size();
+    add_scope_region(region_idx, key);
+    return flood_scope(first, key);
+}
+
+template <class Layout>
+bool Solver<Layout>::flood_scope(long unsigned int first, std::uint64_t &key) {
+    const int *offsets = layout.get_adj_offsets();
+    for (long unsigned int i = first; i < flood_queue.size(); i++) {
+        if (flood_queue.size() > CONFLICT_SCOPE_LIMIT) return false;
+
+        for (int dir = 0; dir < 4; dir++) {
+            CellIdx idx = flood_queue[i] + offsets[dir];
+            if (cell_marks[idx] == mark_stamp) continue;
+
+            Cell &cell = board.at(idx);
+            if (cell.region_id == -1) {
+                cell_marks[idx] = mark_stamp;
+                key ^= zobrist_key(idx, 0);
+                flood_queue.push_back(idx);
+                continue;
+            }
+
+            // clues of the single cells and the border never change
+            int adj_region_idx = region_idx_of(idx);
+            if (adj_region_idx == -1) continue;
+
+            if (is_completed(adj_region_idx)) {
+                // cells around the scope are keyed as cells with negative indexes, so they never match cells in it
+                cell_marks[idx] = mark_stamp;
+                key ^= zobrist_key(-1 - idx, cell.get_value());
+            }
+            if (region_marks[adj_region_idx] != mark_stamp) {
+                add_scope_region(adj_region_idx, key);
+            }
+        }
+    }
+
+    return true;
+}
+
+template <class Layout>
+bool Solver<Layout>::add_level_scope(int level, std::uint64_t &key, bool &is_closed) {
+    SearchLevel &search_level = levels[level];
+    new_mark_pass();
+    flood_queue.clear();
+    scope_levels.clear();
+    // sizes of the blank node depend on the area of its cell and the values around it
+    SearchFrame &frame = frames[search_level.frame_idx];
+    if (frame.blank_cell != -1) {
+        cell_marks[frame.blank_cell] = mark_stamp;
+        flood_queue.push_back(frame.blank_cell);
+        if (!flood_scope(0, key)) return false;
+    } else if (!add_scope(frame.region_idx, key)) {
+        return false;
+    }
+
+    // propagation reaches the regions at distance 2, they can be behind the completed ones
+    for (long unsigned int i = 0; i < search_level.checked_regions.size(); i++) {
+        int region_idx = search_level.checked_regions[i];
+        if (region_marks[region_idx] == mark_stamp) continue;
+
+        is_closed = false;
+        if (!add_scope(region_idx, key)) return false;
+    }
+
+    // size of the blank region was chosen by the blank node, the level before
+    if (search_level.frame_idx > 0 && frames[search_level.frame_idx - 1].blank_cell != -1) {
+        scope_levels.push_back(level - 1);
+    }
+
+    merge_conflict(level, scope_levels, 0);
+    return true;
+}
+
+template <class Layout>
+void Solver<Layout>::merge_conflict(int level, std::vector<int> &conflict, int floor) {
+    SearchLevel &search_level = levels[level];
+    search_level.conflict_floor = std::max(search_level.conflict_floor, std::min(floor, level));
+
+    // both lists are sorted, the union is built in the scratch and swapped in
+    std::sort(conflict.begin(), conflict.end());
+    std::vector<int> &own = search_level.conflict;
+    conflict_scratch.clear();
+    long unsigned int i = 0;
+    long unsigned int j = 0;
+    while (i < own.size() || j < conflict.size()) {
+        int next = j == conflict.size() || (i < own.size() && own[i] <= conflict[j]) ? own[i++] : conflict[j++];
+        if (next < search_level.conflict_floor || next >= level) continue;
+        if (!conflict_scratch.empty() && conflict_scratch.back() == next) continue;
+
+        conflict_scratch.push_back(next);
+    }
+
+    // lower levels are given up first, the next jumps need the latest ones
+    int extra_count = static_cast<int>(conflict_scratch.size()) - CONFLICT_MAX_LEVELS;
+    if (extra_count > 0) {
+        search_level.conflict_floor = conflict_scratch[extra_count - 1] + 1;
+        conflict_scratch.erase(conflict_scratch.begin(), conflict_scratch.begin() + extra_count);
+    }
+
+    std::swap(own, conflict_scratch);
+}
+
+template <class Layout>
+int Solver<Layout>::conflict_target(int level) {
+    SearchLevel &search_level = levels[level];
+    int target = search_level.conflict_floor - 1;
+    if (!search_level.conflict.empty()) {
+        target = std::max(target, search_level.conflict.back());
+    }
+
+    return target;
+}
+
+template <class Layout>
+void Solver<Layout>::backjump(int base_depth) {
+    int level = level_count - 1;
+    SearchLevel &failed = levels[level];
+
+    // split level didn't try all children, so its failure is blamed on all previous levels
+    std::uint64_t key = 0;
+    bool is_closed = true;
+    if (failed.is_split || !add_level_scope(level, key, is_closed)) {
+        failed.conflict_floor = level;
+    } else if (failed.is_leaf && is_closed) {
+        learned_nogoods.insert(key, step_count - frames.back().step_mark);
+    }
+
+    // the conflict is taken out of the level, so merging into the target doesn't reallocate it
+    int target = conflict_target(level);
+    int floor = failed.conflict_floor;
+    std::vector<int> conflict;
+    std::swap(conflict, failed.conflict);
+
+    // region node of the level after the target is the first one popped, nodes of the task's path stay
+    int depth = std::max(levels[target + 1].frame_idx, base_depth);
+    while (static_cast<int>(frames.size()) > depth) {
+        pop_frame();
+    }
+
+    if (target != -1 && target < level_count) {
+        merge_conflict(target, conflict, floor);
+    }
+
+    std::swap(conflict, failed.conflict);
+}
+
+template <class Layout>
+bool Solver<Layout>::is_known_nogood(int region_idx) {
+    if (learned_nogoods.is_empty()) return false;
+
+    std::uint64_t key = 0;
+    new_mark_pass();
+    flood_queue.clear();
+    scope_levels.clear();
+    return add_scope(region_idx, key) && learned_nogoods.contains(key);
+}
+
+// =-=-=-=-=-=-=-= Public methods =-=-=-=-=-=-=-=
+template <class Layout>
+int Solver<Layout>::start() {
+    // context of the previous solve
+    solution_count = 0;
+    has_first_solution = false;
+    solution_cells.clear();
+    regions.clear();
+    merged_into.clear();
+    frames.clear();
+    untried.clear();
+    seen_trail.clear();
+    trail.clear();
+    propagation_queue.clear();
+
+    if (!validate_single_cells(&board)) return 0;
+    if (!create_regions()) return 0;
+    if (regions.empty() && !board.fills_all_cells) {
+        fill_empty_board(board);
+        count_start_solution();
+        return 1;
+    }
+
+    // every cell is added at most once in the branch, so the trail rarely grows during the search.
+    // Other stacks grow geometrically and keep their memory when popped
+    trail.reserve(board.get_rows() * board.get_cols());
+
+    region_heap.reset(static_cast<int>(regions.size()), config.tie_seed);
+    cell_marks.assign(layout.get_grid_size(), 0);
+    cell_levels.assign(layout.get_grid_size(), -1);
+    level_count = 0;
+    first_blank_idx = static_cast<int>(regions.size());
+    blank_depth = 0;
+    blank_scan_idx = board.idx_of(0, 0);
+    if (config.uses_backjumping) {
+        learned_nogoods.configure(NOGOOD_TABLE_MB, ReplacementPolicy::KeepCostly);
+        learned_nogoods.new_puzzle();
+    }
+    region_marks.assign(regions.size(), 0);
+    seen_ids.assign(layout.get_grid_size(), 0);
+    for (int i = 0; i < static_cast<int>(regions.size()); i++) {
+        enqueue_region(i);
+    }
+    closed_area_cell = -1;
+    if (!propagate() || !check_all_areas()) return 0;
+
+    root_region_idx = next_open_region();
+    root_blank_cell = next_blank_cell(root_region_idx != -1);
+    if (root_region_idx == -1 && root_blank_cell == -1) {
+        fill_result();
+        count_start_solution();
+        return 1;
+    }
+
+    return -1;
+}
+
+template <class Layout>
+bool Solver<Layout>::search_from_root() {
+    push_root_frame();
+    search(0);
+    restore_solution();
+    return solution_count > 0;
+}
+
+template <class Layout>
+bool Solver<Layout>::solve() {
+    int state = start();
+    if (state != -1) return state == 1;
+
+    return search_from_root();
+}
+
+template <class Layout>
+void Solver<Layout>::add_component(int begin) {
+    const int *offsets = layout.get_adj_offsets();
+
+    // flood fill over the free cells and the unfinished regions, cells of the component are used as a queue
+    ComponentBounds bounds;
+    bounds.begin = begin;
+    area_regions.clear();
+    flood_queue.clear(); // clues of the single cells around the component
+    for (long unsigned int j = bounds.begin; j < component_cells.size(); j++) {
+        for (int dir = 0; dir < 4; dir++) {
+            CellIdx idx = component_cells[j] + offsets[dir];
+            if (cell_marks[idx] == mark_stamp) continue;
+
+            if (board.at(idx).region_id == -1) {
+                cell_marks[idx] = mark_stamp;
+                component_cells.push_back(idx);
+                continue;
+            }
+
+            // full fill: blank regions of 1 can't touch the clues of 1, so they are around the component too
+            int region_idx = region_idx_of(idx);
+            if (region_idx == -1 && board.fills_all_cells && board.at(idx).region_id != BORDER_REGION_ID) {
+                cell_marks[idx] = mark_stamp;
+                flood_queue.push_back(idx);
+            }
+            if (region_idx == -1 || region_marks[region_idx] == mark_stamp) continue;
+
+            region_marks[region_idx] = mark_stamp;
+            if (is_completed(region_idx)) {
+                area_regions.push_back(region_idx);
+                continue;
+            }
+
+            Region &region = regions[region_idx];
+            for (int k = 0; k < region.get_size(); k++) {
+                cell_marks[region.cell_at(k)] = mark_stamp;
+                component_cells.push_back(region.cell_at(k));
+            }
+        }
+    }
+
+    bounds.inside_end = static_cast<int>(component_cells.size());
+    for (long unsigned int j = 0; j < flood_queue.size(); j++) {
+        cell_marks[flood_queue[j]] = 0;
+        component_cells.push_back(flood_queue[j]);
+    }
+    for (long unsigned int j = 0; j < area_regions.size(); j++) {
+        Region &region = regions[area_regions[j]];
+        region_marks[area_regions[j]] = 0;
+        for (int k = 0; k < region.get_size(); k++) {
+            component_cells.push_back(region.cell_at(k));
+        }
+    }
+
+    bounds.end = static_cast<int>(component_cells.size());
+    component_bounds.push_back(bounds);
+}
+
+template <class Layout>
+int Solver<Layout>::find_components() {
+    component_cells.clear();
+    component_bounds.clear();
+
+    // one pass marks the cells and the unfinished regions of all components. Completed regions and
+    // single cells are unmarked after every component, they can border the next one too
+    new_mark_pass();
+    for (int i = 0; i < static_cast<int>(regions.size()); i++) {
+        if (merged_into[i] != -1 || is_completed(i) || region_marks[i] == mark_stamp) continue;
+
+        int begin = static_cast<int>(component_cells.size());
+        region_marks[i] = mark_stamp;
+        for (int j = 0; j < regions[i].get_size(); j++) {
+            cell_marks[regions[i].cell_at(j)] = mark_stamp;
+            component_cells.push_back(regions[i].cell_at(j));
+        }
+
+        add_component(begin);
+    }
+
+    // the full fill also fills the areas that no region reaches
+    for (int row = 0; row < board.get_rows() && board.fills_all_cells; row++) {
+        for (int col = 0; col < board.get_cols(); col++) {
+            CellIdx idx = board.idx_of(row, col);
+            if (board.at(idx).region_id != -1 || cell_marks[idx] == mark_stamp) continue;
+
+            int begin = static_cast<int>(component_cells.size());
+            cell_marks[idx] = mark_stamp;
+            component_cells.push_back(idx);
+            add_component(begin);
+        }
+    }
+
+    return static_cast<int>(component_bounds.size());
+}
+
+template <class Layout>
+void Solver<Layout>::set_config(const SearchConfig &config) {
+    this->config = config;
+}
+
+template <class Layout>
+void Solver<Layout>::set_solution_limit(int solution_limit) {
+    this->solution_limit = solution_limit;
+}
+
+template <class Layout>
+void Solver<Layout>::set_failed_states(TranspositionTable *p_failed_states) {
+    this->p_failed_states = p_failed_states;
+}
+
+template <class Layout>
+void Solver<Layout>::set_parallel(ParallelSearch *p_parallel, int thread_idx) {
+    this->p_parallel = p_parallel;
+    this->thread_idx = thread_idx;
+}
+
+template <class Layout>
+bool Solver<Layout>::run_task(const SearchTask &task) {
+    while (!frames.empty()) {
+        pop_frame();
+    }
+
+    // children on the path were pushed by the thread that made the task, so they are pushed again
+    push_root_frame();
+    for (long unsigned int i = 0; i < task.path.size(); i++) {
+        child_pos_of(frames.back()) = task.path[i];
+        SearchStep step = push_next_child();
+        if (step == SearchStep::Solved) return count_solution();
+
+        // nogoods learned by the previous tasks of the thread can cut the path
+        if (step == SearchStep::DeadEnd) return false;
+    }
+
+    SearchFrame &frame = frames.back();
+    if (task.child_begin > child_pos_of(frame)) {
+        child_pos_of(frame) = task.child_begin;
+    }
+    if (task.child_end < frame.child_end) {
+        frame.child_end = task.child_end;
+    }
+
+    // the root task is the whole tree, others are parts of the split nodes
+    frame.is_split = task.child_end != INT_MAX;
+    levels[level_count - 1].is_split = frame.is_split;
+
+    task_depth = static_cast<int>(frames.size()) - 1;
+    return search(task_depth);
+}
+
+template <class Layout>
+bool Solver<Layout>::restore_solution() {
+    if (!has_first_solution) return false;
+
+    // the result isn't undone by the search, only the cells are
+    for (long unsigned int i = 0; i < solution_cells.size(); i++) {
+        board.at(static_cast<CellIdx>(i)) = solution_cells[i];
+    }
+
+    return true;
+}
+
+SearchConfig portfolio_config(int idx) {
+    // directions are rotated and mirrored, every third configuration checks areas of any size or none
+    SearchConfig config = DEFAULT_SEARCH_CONFIG;
+    for (int i = 0; i < 4; i++) {
+        int dir = (i + idx) % 4;
+        config.directions[i] = (idx / 4) % 2 == 0 ? dir : 3 - dir;
+    }
+
+    config.tie_seed = idx;
+    if (idx % 3 == 1) {
+        config.area_check_limit = INT_MAX;
+    } else if (idx % 3 == 2) {
+        config.area_check_limit = 0;
+    }
+
+    return config;
+}
+
+template class Solver<DynamicLayout>;
+template class Solver<Layout8x8>;
+template class Solver<Layout10x10>;
+template class Solver<Layout12x12>;
+template class Solver<Layout16x16>;
+
+// !* helper function *!
+// Contexts of the threads 1..thread_count - 1 are created before the threads start
+void reserve_thread_contexts(SolverContext &context, int thread_count) {
+    while (static_cast<int>(context.thread_contexts.size()) < thread_count - 1) {
+        context.thread_contexts.emplace_back(new SolverContext());
+    }
+}
+
+// !* helper function *!
+// Thread of the parallel search. The first solution is copied to the board by the thread that found it
+template <class Layout>
+void run_search_thread(Board &board, ParallelSearch &parallel, int thread_idx, Solver<Layout> &solver, Board &own_board) {
+    solver.set_parallel(&parallel, thread_idx);
+
+    SearchTask task;
+    while (parallel.next_task(thread_idx, task)) {
+        solver.run_task(task);
+        parallel.finish_task();
+    }
+
+    if (solver.restore_solution()) {
+        board.copy_from(own_board);
+    }
+}
+
+// !* helper function *!
+template <class Layout>
+void start_search_thread(
+    Board &board, ParallelSearch &parallel, int thread_idx, Board &own_board, SolverContext &context
+) {
+    // the start is the same in every thread, so are the nodes rebuilt from the paths
+    Solver<Layout> solver(own_board, context);
+    if (solver.start() != -1) return;
+
+    run_search_thread(board, parallel, thread_idx, solver, own_board);
+}
+
+// !* helper function *!
+// Thread of the portfolio, it searches the whole tree. The first thread that finishes has the answer
+template <class Layout>
+void run_portfolio_thread(
+    Board &board, ParallelSearch &parallel, int thread_idx, Board &own_board, SolverContext &context,
+    TranspositionTable &failed_states, bool &is_solved
+) {
+    // configurations solve the same puzzle, so they share the failed states
+    Solver<Layout> solver(own_board, context);
+    solver.set_config(portfolio_config(thread_idx));
+    solver.set_failed_states(&failed_states);
+    solver.set_parallel(&parallel, thread_idx); // nobody takes tasks, so the solver only checks the stop
+
+    // stopped threads return false only after the answer was claimed. The solution is claimed
+    // by the solver (see ParallelSearch::add_solution), the failure is claimed here
+    bool is_own_solved = solver.solve();
+    if (is_own_solved ? solver.restore_solution() : parallel.stop()) {
+        if (is_own_solved) {
+            board.copy_from(own_board);
+        }
+
+        is_solved = is_own_solved;
+    }
+}
+
+// !* helper function *!
+template <class Layout>
+bool solve_portfolio(Board &board, SolverContext &context, int thread_count) {
+    context.failed_states.new_puzzle();
+    reserve_thread_contexts(context, thread_count);
+
+    // copies are made before any thread starts, the board is written by the thread that finishes first
+    std::vector<Board *> thread_boards;
+    for (int i = 0; i < thread_count; i++) {
+        thread_boards.push_back(new Board(board.get_rows(), board.get_cols()));
+        thread_boards.back()->copy_from(board);
+    }
+
+    ParallelSearch parallel(thread_count);
+    bool is_solved = false;
+    std::vector<std::thread> threads;
+    for (int i = 1; i < thread_count; i++) {
+        threads.emplace_back(
+            run_portfolio_thread<Layout>, std::ref(board), std::ref(parallel), i, std::ref(*thread_boards[i]),
+            std::ref(*context.thread_contexts[i - 1]), std::ref(context.failed_states), std::ref(is_solved)
+        );
+    }
+
+    run_portfolio_thread<Layout>(board, parallel, 0, *thread_boards[0], context, context.failed_states, is_solved);
+    for (long unsigned int i = 0; i < threads.size(); i++) {
+        threads[i].join();
+    }
+
+    for (int i = 0; i < thread_count; i++) {
+        delete thread_boards[i];
+    }
+
+    return is_solved;
+}
+
+// !* helper function *!
+// Board of the component cut to the box around it: own cells of the component are free cells or clues
+// (cells of the unfinished regions), the regions around it are clues too, so the regions of the same value
+// can't touch them. The rest of the box is sentinels
+Board *make_component_board(Board &board, std::vector<CellIdx> &cells, ComponentBounds bounds, Coord &origin) {
+    Coord last = board.coord_of(cells[bounds.begin]);
+    origin = last;
+    for (int i = bounds.begin; i < bounds.end; i++) {
+        Coord coord = board.coord_of(cells[i]);
+        origin = Coord(std::min(origin.row, coord.row), std::min(origin.col, coord.col));
+        last = Coord(std::max(last.row, coord.row), std::max(last.col, coord.col));
+    }
+
+    Board *p_part = new Board(last.row - origin.row + 1, last.col - origin.col + 1);
+    p_part->fills_all_cells = board.fills_all_cells;
+    for (int row = 0; row < p_part->get_rows(); row++) {
+        for (int col = 0; col < p_part->get_cols(); col++) {
+            Cell &cell = p_part->cell_at(row, col);
+            cell = Cell(0, true);
+            cell.region_id = BORDER_REGION_ID;
+        }
+    }
+
+    for (int i = bounds.begin; i < bounds.end; i++) {
+        Cell &cell = board.at(cells[i]);
+        Coord coord = board.coord_of(cells[i]);
+        CellIdx idx = p_part->idx_of(coord.row - origin.row, coord.col - origin.col);
+        if (cell.region_id == -1) {
+            p_part->at(idx) = Cell();
+            continue;
+        }
+
+        p_part->at(idx) = Cell(cell.get_value());
+    }
+
+    // clues are listed in the order of the board, as in Board::create_fixed_cells_list, so are the regions
+    for (int row = 0; row < p_part->get_rows(); row++) {
+        for (int col = 0; col < p_part->get_cols(); col++) {
+            Cell &cell = p_part->cell_at(row, col);
+            if (cell.get_is_fixed() && cell.region_id == -1) {
+                p_part->fixed_cells.push_back(p_part->idx_of(row, col));
+            }
+        }
+    }
+
+    return p_part;
+}
+
+// !* helper function *!
+// Thread of the component solving. Components are taken one by one, the first failed one stops the others
+void solve_components_thread(
+    std::vector<Board *> &parts, std::vector<int> &counts, SolverContext &context, int solution_limit,
+    std::atomic<int> &next_idx, std::atomic<bool> &is_failed
+) {
+    for (int i = next_idx.fetch_add(1); i < static_cast<int>(parts.size()); i = next_idx.fetch_add(1)) {
+        if (is_failed.load()) return;
+
+        counts[i] = count_solutions(*parts[i], context, solution_limit);
+        if (counts[i] == 0) {
+            is_failed.store(true);
+        }
+    }
+}
+
+// !* helper function *!
+// Solves the components found by Solver::find_components on their own boards, with the threads
+// if there are more than one, and copies them into the board. Cells outside the components were filled by the start.
+// Solutions of the board are all combinations of the solutions of the components, so the count is the product
+int solve_components(Board &board, SolverContext &context, int thread_count, int solution_limit) {
+    // parts are cut out before the solving, their solves reuse the context
+    std::vector<ComponentBounds> &bounds = context.component_bounds;
+    std::vector<Board *> parts;
+    std::vector<Coord> origins(bounds.size());
+    std::vector<char> is_inside(board.get_grid_size(), 0);
+    for (long unsigned int i = 0; i < bounds.size(); i++) {
+        parts.push_back(make_component_board(board, context.component_cells, bounds[i], origins[i]));
+        for (int j = bounds[i].begin; j < bounds[i].inside_end; j++) {
+            is_inside[context.component_cells[j]] = 1;
+        }
+    }
+
+    // single cells are already in the result
+    for (int row = 0; row < board.get_rows(); row++) {
+        for (int col = 0; col < board.get_cols(); col++) {
+            CellIdx idx = board.idx_of(row, col);
+            if (!is_inside[idx] && board.at(idx).region_id >= 0) {
+                board.result.push_back(Coord(row, col));
+            }
+        }
+    }
+
+    std::vector<int> counts(parts.size(), 0);
+    std::atomic<int> next_idx(0);
+    std::atomic<bool> is_failed(false);
+    int extra_threads = std::min(thread_count, static_cast<int>(parts.size())) - 1;
+    reserve_thread_contexts(context, extra_threads + 1);
+    std::vector<std::thread> threads;
+    for (int i = 0; i < extra_threads; i++) {
+        threads.emplace_back(
+            solve_components_thread, std::ref(parts), std::ref(counts), std::ref(*context.thread_contexts[i]),
+            solution_limit,
+            std::ref(next_idx), std::ref(is_failed)
+        );
+    }
+
+    solve_components_thread(parts, counts, context, solution_limit, next_idx, is_failed);
+    for (long unsigned int i = 0; i < threads.size(); i++) {
+        threads[i].join();
+    }
+
+    // regions of the parts get new ids of the board, the ids of different parts overlap
+    std::vector<int> region_ids;
+    for (long unsigned int i = 0; i < parts.size() && !is_failed.load(); i++) {
+        Board &part = *parts[i];
+        region_ids.clear();
+        for (long unsigned int j = 0; j < part.result.size(); j++) {
+            Coord coord(part.result[j].row + origins[i].row, part.result[j].col + origins[i].col);
+            CellIdx idx = board.idx_of(coord);
+            if (!is_inside[idx]) continue;
+
+            Cell &part_cell = part.cell_at(part.result[j]);
+            if (part_cell.region_id >= static_cast<int>(region_ids.size())) {
+                region_ids.resize(part_cell.region_id + 1, -1);
+            }
+            if (region_ids[part_cell.region_id] == -1) {
+                region_ids[part_cell.region_id] = board.create_region(part_cell.get_value()).get_id();
+            }
+
+            Cell &cell = board.at(idx);
+            cell.set_value(part_cell.get_value());
+            cell.region_id = region_ids[part_cell.region_id];
+            board.result.push_back(coord);
+        }
+    }
+
+    // both factors are at most the limit, so their product fits into long long before it's capped
+    int solution_count = is_failed.load() ? 0 : 1;
+    for (long unsigned int i = 0; i < parts.size(); i++) {
+        if (solution_count > 0) {
+            long long product = static_cast<long long>(solution_count) * counts[i];
+            solution_count = static_cast<int>(std::min(product, static_cast<long long>(solution_limit)));
+        }
+
+        delete parts[i];
+    }
+
+    return solution_count;
+}
+
+// !* helper function *!
+template <class Layout>
+int solve_with_layout(Board &board, SolverContext &context, SolverEngine engine, int thread_count, int solution_limit) {
+    if (engine == SolverEngine::Portfolio && solution_limit == 1) {
+        return solve_portfolio<Layout>(board, context, thread_count > 1 ? thread_count : PORTFOLIO_DEFAULT_SIZE);
+    }
+
+    if (thread_count <= 1) {
+        Solver<Layout> solver(board, context);
+        solver.set_solution_limit(solution_limit);
+        int state = solver.start();
+        if (state != -1) return state;
+        if (solver.find_components() > 1) return solve_components(board, context, 1, solution_limit);
+
+        solver.search_from_root();
+        return solver.get_solution_count();
+    }
+
+    // the main thread starts on its own copy, so the board stays clean for the other threads
+    Board own_board(board.get_rows(), board.get_cols());
+    own_board.copy_from(board);
+    Solver<Layout> solver(own_board, context);
+    int state = solver.start();
+    if (state != -1) {
+        board.copy_from(own_board);
+        return state;
+    }
+
+    // components are spread over the threads instead of splitting one search
+    if (solver.find_components() > 1) {
+        board.copy_from(own_board);
+        return solve_components(board, context, thread_count, solution_limit);
+    }
+
+    ParallelSearch parallel(thread_count, solution_limit);
+    parallel.push_task(0, { std::vector<int>(), 0, INT_MAX });
+
+    // copies are made before any thread starts, the board is written by the thread that solves it
+    std::vector<Board *> thread_boards;
+    for (int i = 1; i < thread_count; i++) {
+        thread_boards.push_back(new Board(board.get_rows(), board.get_cols()));
+        thread_boards.back()->copy_from(board);
+    }
+
+    reserve_thread_contexts(context, thread_count);
+    std::vector<std::thread> threads;
+    for (int i = 1; i < thread_count; i++) {
+        threads.emplace_back(
+            start_search_thread<Layout>, std::ref(board), std::ref(parallel), i, std::ref(*thread_boards[i - 1]),
+            std::ref(*context.thread_contexts[i - 1])
+        );
+    }
+
+    run_search_thread(board, parallel, 0, solver, own_board);
+    for (long unsigned int i = 0; i < threads.size(); i++) {
+        threads[i].join();
+        delete thread_boards[i];
+    }
+
+    return parallel.get_solution_count();
+}
+
+// !* helper function *!
+// Returns the number of solutions up to the limit
+int solve_board(Board &board, SolverContext &context, SolverEngine engine, int thread_count, int solution_limit) {
+    // shapes of the exact cover are the shapes of the clues, cells that no clue reaches can't be covered
+    if (engine == SolverEngine::ExactCover && !board.fills_all_cells) {
+        ExactCoverSolver exact_cover_solver(board);
+        int solution_count = exact_cover_solver.solve(solution_limit);
+        if (solution_count != -1) return solution_count;
+    }
+
+    int rows = board.get_rows();
+    int cols = board.get_cols();
+    if (rows == 8 && cols == 8) {
+        return solve_with_layout<Layout8x8>(board, context, engine, thread_count, solution_limit);
+    }
+    if (rows == 10 && cols == 10) {
+        return solve_with_layout<Layout10x10>(board, context, engine, thread_count, solution_limit);
+    }
+    if (rows == 12 && cols == 12) {
+        return solve_with_layout<Layout12x12>(board, context, engine, thread_count, solution_limit);
+    }
+    if (rows == 16 && cols == 16) {
+        return solve_with_layout<Layout16x16>(board, context, engine, thread_count, solution_limit);
+    }
+
+    return solve_with_layout<DynamicLayout>(board, context, engine, thread_count, solution_limit);
+}
+
+bool solve(Board &board, SolverEngine engine, int thread_count) {
+    SolverContext context;
+    return solve_board(board, context, engine, thread_count, 1) > 0;
+}
+
+bool solve(Board &board, SolverContext &context, SolverEngine engine, int thread_count) {
+    return solve_board(board, context, engine, thread_count, 1) > 0;
+}
+
+int count_solutions(Board &board, SolverContext &context, int solution_limit, SolverEngine engine, int thread_count) {
+    return solve_board(board, context, engine, thread_count, std::max(solution_limit, 1));
+}
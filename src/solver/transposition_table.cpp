@@ -0,0 +1,75 @@
+#include "solver/transposition_table.h"
+
+TranspositionTable::TranspositionTable()
+    : max_mb(TABLE_DEFAULT_MB), policy(ReplacementPolicy::KeepCostly), epoch(0), has_entries(false) {}
+
+void TranspositionTable::configure(int max_mb, ReplacementPolicy policy) {
+    this->max_mb = max_mb;
+    this->policy = policy;
+}
+
+void TranspositionTable::new_puzzle() {
+    // bucket count is the biggest power of 2 that fits, so the bucket is found by the mask
+    long long max_entries = static_cast<long long>(max_mb) * 1024 * 1024 / sizeof(Entry);
+    long long entry_count = 0;
+    while ((entry_count == 0 ? TABLE_WAYS : entry_count * 2) <= max_entries) {
+        entry_count = entry_count == 0 ? TABLE_WAYS : entry_count * 2;
+    }
+
+    epoch++;
+    has_entries.store(false);
+    if (static_cast<long long>(entries.size()) != entry_count || epoch == 0) {
+        entries.assign(entry_count, { 0, 0, 0 });
+        epoch = 1;
+    }
+}
+
+bool TranspositionTable::contains(std::uint64_t key) {
+    if (!has_entries.load(std::memory_order_relaxed)) return false;
+
+    std::size_t bucket = key & (entries.size() / TABLE_WAYS - 1);
+    std::lock_guard<std::mutex> lock(stripes[bucket % TABLE_STRIPES]);
+
+    Entry *bucket_entries = &entries[bucket * TABLE_WAYS];
+    for (int i = 0; i < TABLE_WAYS; i++) {
+        if (bucket_entries[i].epoch == epoch && bucket_entries[i].key == key) return true;
+    }
+
+    return false;
+}
+
+void TranspositionTable::insert(std::uint64_t key, long long cost) {
+    if (entries.empty() || cost < TABLE_MIN_COST) return;
+
+    std::uint32_t entry_cost = cost < UINT32_MAX ? static_cast<std::uint32_t>(cost) : UINT32_MAX;
+    std::size_t bucket = key & (entries.size() / TABLE_WAYS - 1);
+    std::lock_guard<std::mutex> lock(stripes[bucket % TABLE_STRIPES]);
+
+    // empty entries are taken first, otherwise the victim is chosen by the policy
+    Entry *bucket_entries = &entries[bucket * TABLE_WAYS];
+    Entry *p_victim = nullptr;
+    for (int i = 0; i < TABLE_WAYS; i++) {
+        Entry &entry = bucket_entries[i];
+        if (entry.epoch != epoch) {
+            p_victim = &entry;
+            break;
+        }
+        if (entry.key == key) return;
+
+        if (!p_victim || entry.cost < p_victim->cost) {
+            p_victim = &entry;
+        }
+    }
+
+    if (p_victim->epoch == epoch) {
+        if (policy == ReplacementPolicy::Always) {
+            // the high bits of the key aren't used by the bucket index
+            p_victim = &bucket_entries[(key >> 62) % TABLE_WAYS];
+        } else if (p_victim->cost > entry_cost) {
+            return;
+        }
+    }
+
+    *p_victim = { key, epoch, entry_cost };
+    has_entries.store(true, std::memory_order_relaxed);
+}
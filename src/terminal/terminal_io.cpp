@@ -16,7 +16,6 @@
 #include <cctype>
 #include <unistd.h>
 
-#define MAX_CELL_VAL 99
 #define DRAW_INTERVAL 300 // in ms
 
 using std::cout;
@@ -382,12 +381,12 @@ int Terminal::get_size() {
     cout << CURSOR_SAVE;
 
     int input = -1;
-    while (input <= 0 || input > BOARD_MAX_SIZE) {
+    while (input <= 0 || input > TERMINAL_MAX_SIZE) {
         cin >> input;
-        if (cin.fail() || input <= 0 || input > BOARD_MAX_SIZE) {
+        if (cin.fail() || input <= 0 || input > TERMINAL_MAX_SIZE) {
             cin.clear();
             cout << CURSOR_RESTORE CURSOR_NEXT_LINE FONT_RED BOLD 
-                << "Invalid number! Number must be in range 1 - " << BOARD_MAX_SIZE
+                << "Invalid number! Number must be in range 1 - " << TERMINAL_MAX_SIZE
                 << RESET_ALL CURSOR_RESTORE ERASE_CURSOR_TO_LINE_END;
         }
 
@@ -401,7 +400,7 @@ int Terminal::get_size() {
 void Terminal::ask_board_sizes(int &rows, int &cols) {
     clear_terminal();
     cout << "Creating board (max size is "
-        << BOARD_MAX_SIZE << "x" << BOARD_MAX_SIZE << ")\n";
+        << TERMINAL_MAX_SIZE << "x" << TERMINAL_MAX_SIZE << ")\n";
 
     cout << "Enter number of rows: ";
     rows = get_size();